@@ -0,0 +1,19 @@
+#include "ofMain.h"
+#include "ofAppNoWindow.h"
+#include "ofApp.h"
+
+//========================================================================
+int main(int argc, char* argv[]){
+
+	// no GL context, the benchmark only decodes
+	ofAppNoWindow window;
+	ofSetupOpenGL(&window, 1024,768, OF_WINDOW);
+
+	// results go to bin/data/benchmark.json unless a path is passed
+	ofApp* app = new ofApp();
+	if(argc > 1){
+		app->outputPath = argv[1];
+	}
+	ofRunApp(app);
+
+}
@@ -0,0 +1,257 @@
+/**
+ *  ofApp.cpp
+ *
+ *	ofxImageSequence benchmark
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofApp.h"
+
+//sequences decoded by every benchmark, edit to match the material of a show
+struct ofxImageSequenceBenchmarkCase {
+	const char* extension;	//bmp stands in for raw frames, uncompressed pixels behind a small header
+	int width;
+	int height;
+	int frames;
+};
+
+static const ofxImageSequenceBenchmarkCase benchmarkCases[] = {
+	{ "png",  640,  360, 240 }, { "png", 1920, 1080, 24 }, { "png", 3840, 2160, 24 },
+	{ "jpg",  640,  360, 240 }, { "jpg", 1920, 1080, 24 }, { "jpg", 3840, 2160, 24 },
+	{ "bmp",  640,  360, 240 }, { "bmp", 1920, 1080, 24 }, { "bmp", 3840, 2160, 24 },
+};
+
+//folder sizes for the scan benchmark, the frames themselves are tiny
+static const int scanFrameCounts[] = { 100, 1000, 10000 };
+static const int scanRuns = 5;
+
+static string getTempFolder()
+{
+#ifdef TARGET_WIN32
+	const char* temp = getenv("TEMP");
+#else
+	const char* temp = getenv("TMPDIR");
+	if(temp == NULL){
+		temp = "/tmp";
+	}
+#endif
+	return temp != NULL ? string(temp) : ofToDataPath("", true);
+}
+
+static double millisSince(uint64_t startMicros)
+{
+	return (ofGetElapsedTimeMicros() - startMicros) / 1000.0;
+}
+
+//mean, median, 95th percentile and range of a set of timings
+static void writeTimings(ostream& json, vector<double> millis)
+{
+	if(millis.empty()){
+		json << "null";
+		return;
+	}
+	sort(millis.begin(), millis.end());
+	double total = 0;
+	for(int i = 0; i < millis.size(); i++){
+		total += millis[i];
+	}
+	json << "{\"mean\": " << total / millis.size()
+		 << ", \"p50\": " << millis[millis.size() / 2]
+		 << ", \"p95\": " << millis[MIN((int)(millis.size() * 0.95), (int)millis.size() - 1)]
+		 << ", \"min\": " << millis.front()
+		 << ", \"max\": " << millis.back() << "}";
+}
+
+//--------------------------------------------------------------
+ofApp::ofApp(){
+	outputPath = "benchmark.json";
+}
+
+//--------------------------------------------------------------
+void ofApp::setup(){
+	tempFolder = ofFilePath::join(getTempFolder(), "ofxImageSequenceBenchmark");
+	ofDirectory::removeDirectory(tempFolder, true, false);
+	ofDirectory::createDirectory(tempFolder, false, true);
+
+	stringstream json;
+	json << "{\n";
+	json << "\t\"timestamp\": \"" << ofGetTimestampString() << "\",\n";
+	json << "\t\"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+
+	json << "\t\"scan\": [\n";
+	int numScans = sizeof(scanFrameCounts) / sizeof(scanFrameCounts[0]);
+	for(int i = 0; i < numScans; i++){
+		benchmarkScan(json, scanFrameCounts[i]);
+		json << (i + 1 < numScans ? ",\n" : "\n");
+	}
+	json << "\t],\n";
+
+	json << "\t\"sequences\": [\n";
+	int numCases = sizeof(benchmarkCases) / sizeof(benchmarkCases[0]);
+	for(int i = 0; i < numCases; i++){
+		const ofxImageSequenceBenchmarkCase& c = benchmarkCases[i];
+		benchmarkSequence(json, c.extension, c.width, c.height, c.frames);
+		json << (i + 1 < numCases ? ",\n" : "\n");
+	}
+	json << "\t]\n";
+	json << "}\n";
+
+	ofDirectory::removeDirectory(tempFolder, true, false);
+
+	ofstream file(ofToDataPath(outputPath).c_str());
+	file << json.str();
+	ofLogNotice("ofApp") << "Benchmark results written to " << ofToDataPath(outputPath, true);
+
+	ofExit();
+}
+
+//--------------------------------------------------------------
+//a moving gradient with some noise, so compressed formats can't shrink frames to nothing
+string ofApp::generateSequence(string name, string extension, int width, int height, int frames){
+	string folder = ofFilePath::join(tempFolder, name);
+	ofDirectory::createDirectory(folder, false, true);
+
+	ofPixels pixels;
+	pixels.allocate(width, height, OF_PIXELS_RGB);
+	unsigned int seed = 1;
+	for(int f = 0; f < frames; f++){
+		unsigned char* data = pixels.getData();
+		for(int y = 0; y < height; y++){
+			for(int x = 0; x < width; x++){
+				seed = seed * 1664525u + 1013904223u;
+				unsigned char* pixel = data + (y * width + x) * 3;
+				pixel[0] = x + f * 4;
+				pixel[1] = y + f * 2;
+				pixel[2] = ((x ^ y) & 0xe0) + (seed >> 27);
+			}
+		}
+		ofSaveImage(pixels, ofFilePath::join(folder, "frame" + ofToString(f, 5, '0') + "." + extension), OF_IMAGE_QUALITY_HIGH);
+	}
+	return folder;
+}
+
+//--------------------------------------------------------------
+//listing the folder against inferring its numbering, the first run is on a cold file system cache
+void ofApp::benchmarkScan(ostream& json, int frames){
+	string folder = generateSequence("scan" + ofToString(frames), "png", 64, 36, frames);
+	ofLogNotice("ofApp") << "Scanning " << frames << " frames";
+
+	ofxImageSequenceBenchmarkSequence sequence;
+	sequence.setUseTexture(false);
+	vector<double> listMillis, detectMillis, probeMillis;
+	for(int run = 0; run < scanRuns; run++){
+		uint64_t start = ofGetElapsedTimeMicros();
+		sequence.scanFolder(folder);
+		listMillis.push_back(millisSince(start));
+
+		start = ofGetElapsedTimeMicros();
+		ofxImageSequencePattern pattern;
+		pattern.detect(folder);
+		detectMillis.push_back(millisSince(start));
+
+		start = ofGetElapsedTimeMicros();
+		pattern.probe(ofFilePath::join(folder, "frame00000.png"));
+		probeMillis.push_back(millisSince(start));
+	}
+	sequence.unloadSequence();
+
+	json << "\t\t{\"frames\": " << frames;
+	json << ", \"list_ms\": ";
+	writeTimings(json, listMillis);
+	json << ", \"detect_ms\": ";
+	writeTimings(json, detectMillis);
+	json << ", \"probe_ms\": ";
+	writeTimings(json, probeMillis);
+	json << "}";
+}
+
+//--------------------------------------------------------------
+void ofApp::benchmarkSequence(ostream& json, string extension, int width, int height, int frames){
+	string name = extension + ofToString(width) + "x" + ofToString(height) + "x" + ofToString(frames);
+	string folder = generateSequence(name, extension, width, height, frames);
+	ofLogNotice("ofApp") << "Benchmarking " << name;
+
+	ofDirectory dir;
+	dir.listDir(folder);
+	dir.sort();
+	uint64_t bytesOnDisk = 0;
+	for(int i = 0; i < dir.size(); i++){
+		bytesOnDisk += dir.getFile(i).getSize();
+	}
+
+	//the codec alone
+	vector<double> decodeMillis;
+	ofPixels pixels;
+	for(int i = 0; i < dir.size(); i++){
+		uint64_t start = ofGetElapsedTimeMicros();
+		ofLoadImage(pixels, dir.getPath(i));
+		decodeMillis.push_back(millisSince(start));
+	}
+
+	//through the decoded tier: the first request of a frame decodes and stores it, the second finds it
+	vector<double> missMillis, hitMillis;
+	{
+		ofxImageSequence sequence;
+		sequence.setUseTexture(false);
+		sequence.loadSequence(folder);
+		for(int i = 1; i < sequence.getTotalFrames(); i++){
+			uint64_t start = ofGetElapsedTimeMicros();
+			sequence.getPixelsForFrame(i);
+			missMillis.push_back(millisSince(start));
+
+			start = ofGetElapsedTimeMicros();
+			sequence.getPixelsForFrame(i);
+			hitMillis.push_back(millisSince(start));
+		}
+	}
+
+	//preloadAllFrames on one thread, frame 0 is already decoded by the load
+	float preloadFps = 0;
+	{
+		ofxImageSequence sequence;
+		sequence.setUseTexture(false);
+		sequence.loadSequence(folder);
+		uint64_t start = ofGetElapsedTimeMicros();
+		sequence.preloadAllFrames();
+		preloadFps = (sequence.getTotalFrames() - 1) / MAX(millisSince(start) / 1000.0, 1e-6);
+	}
+
+	//the worker pool with nothing kept, doubling the threads up to one per core
+	vector< pair<int, float> > parallelFps;
+	{
+		ofxImageSequence sequence;
+		sequence.setUseTexture(false);
+		sequence.setTierBudget(OFX_IMAGE_SEQUENCE_TIER_DECODED, 0);
+		sequence.loadSequence(folder);
+		int maxThreads = MAX((int)std::thread::hardware_concurrency(), 1);
+		vector<int> threadCounts;
+		for(int threads = 1; threads < maxThreads; threads *= 2){
+			threadCounts.push_back(threads);
+		}
+		threadCounts.push_back(maxThreads);
+		for(int i = 0; i < threadCounts.size(); i++){
+			int threads = threadCounts[i];
+			uint64_t start = ofGetElapsedTimeMicros();
+			sequence.forEachFrame([](int index, const ofPixels& pixels){}, threads);
+			parallelFps.push_back(make_pair(threads, sequence.getTotalFrames() / MAX(millisSince(start) / 1000.0, 1e-6)));
+		}
+	}
+
+	json << "\t\t{\"format\": \"" << extension << "\", \"width\": " << width << ", \"height\": " << height
+		 << ", \"frames\": " << frames << ", \"bytes_on_disk\": " << bytesOnDisk << ",\n";
+	json << "\t\t \"decode_ms\": ";
+	writeTimings(json, decodeMillis);
+	json << ",\n\t\t \"cache_miss_ms\": ";
+	writeTimings(json, missMillis);
+	json << ",\n\t\t \"cache_hit_ms\": ";
+	writeTimings(json, hitMillis);
+	json << ",\n\t\t \"preload_fps\": " << preloadFps;
+	json << ",\n\t\t \"parallel_decode\": [";
+	for(int i = 0; i < parallelFps.size(); i++){
+		json << (i > 0 ? ", " : "") << "{\"threads\": " << parallelFps[i].first << ", \"fps\": " << parallelFps[i].second << "}";
+	}
+	json << "]}";
+
+	ofDirectory::removeDirectory(folder, true, false);
+}
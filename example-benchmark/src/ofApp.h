@@ -0,0 +1,48 @@
+/**
+ *  ofApp.h
+ *
+ *	ofxImageSequence benchmark
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  Headless microbenchmarks of the load path on synthetic sequences generated in a temp folder:
+ *  directory scan, single frame decode, preload throughput per thread count and decoded cache
+ *  hits and misses. Results are written as JSON so runs can be compared between addon versions
+ *  and settings. No GPU is needed, the sequences never upload.
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxImageSequence.h"
+
+//exposes the directory scan on its own, without decoding the first frame
+class ofxImageSequenceBenchmarkSequence : public ofxImageSequence {
+  public:
+	int scanFolder(string folder){
+		unloadSequence();
+		folderToLoad = folder;
+		preloadAllFilenames();
+		return filenames.size();
+	}
+};
+
+class ofApp : public ofBaseApp
+{
+
+  public:
+	ofApp();
+
+	void setup();
+
+	string outputPath;
+
+  protected:
+	string tempFolder;
+
+	string generateSequence(string name, string extension, int width, int height, int frames);
+	void benchmarkScan(ostream& json, int frames);
+	void benchmarkSequence(ostream& json, string extension, int width, int height, int frames);
+};
@@ -0,0 +1,22 @@
+#include "ofMain.h"
+#include "ofAppNoWindow.h"
+#include "ofApp.h"
+
+//========================================================================
+int main(int argc, char* argv[]){
+
+	// no GL context, frames are decoded but never uploaded
+	ofAppNoWindow window;
+	ofSetupOpenGL(&window, 1024,768, OF_WINDOW);
+
+	// plays a sequence folder when one is passed, a synthetic one otherwise
+	ofApp* app = new ofApp();
+	if(argc > 1){
+		app->folder = argv[1];
+	}
+	if(argc > 2){
+		app->outputPath = argv[2];
+	}
+	ofRunApp(app);
+
+}
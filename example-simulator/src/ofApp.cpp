@@ -0,0 +1,387 @@
+/**
+ *  ofApp.cpp
+ *
+ *	ofxImageSequence playback simulator
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofApp.h"
+
+//the show being simulated, edit to match the real one
+static const float refreshRate = 60.0f;			//vsync of the display
+static const float sequenceFrameRate = 60.0f;
+static const float secondsPerPattern = 20.0f;
+static const int decodedBudgetFrames = 90;			//0 keeps every decoded frame
+static const ofxImageSequenceEviction eviction = OFX_IMAGE_SEQUENCE_EVICT_WINDOW;
+static const uint64_t compressedBudgetBytes = 0;	//0 disables the compressed tier
+static const int maxQualityLevel = 0;				//above 0 enables adaptive quality
+
+//the lock step run, played fast enough that the group can't keep up
+static const float groupSpeed = 4.0f;
+static const int groupPrefetchFrames = 4;
+static const float groupMaxWait = 0.1f;
+
+static const char* patternNames[SIMULATOR_NUM_PATTERNS] = { "linear", "loop", "ping_pong", "scrub", "cues" };
+
+//mean and percentiles of a set of timings
+static void writeTimings(ostream& json, vector<double> millis)
+{
+	if(millis.empty()){
+		json << "null";
+		return;
+	}
+	sort(millis.begin(), millis.end());
+	double total = 0;
+	for(int i = 0; i < millis.size(); i++){
+		total += millis[i];
+	}
+	json << "{\"mean\": " << total / millis.size()
+		 << ", \"p50\": " << millis[millis.size() / 2]
+		 << ", \"p95\": " << millis[MIN((int)(millis.size() * 0.95), (int)millis.size() - 1)]
+		 << ", \"p99\": " << millis[MIN((int)(millis.size() * 0.99), (int)millis.size() - 1)]
+		 << ", \"max\": " << millis.back() << "}";
+}
+
+//decoded tier budgets a trace is replayed against, per sequence like setTierBudget,
+//and the cost of a miss for sequences without recorded decodes
+static const uint64_t replayBudgets[] = { 256ull << 20, 512ull << 20, 1ull << 30, 2ull << 30, 4ull << 30, 8ull << 30 };
+static const uint64_t defaultMissMicros = 20000;
+
+static const ofxImageSequenceEviction replayPolicies[] = {
+	OFX_IMAGE_SEQUENCE_EVICT_LRU, OFX_IMAGE_SEQUENCE_EVICT_CLOCK, OFX_IMAGE_SEQUENCE_EVICT_ARC, OFX_IMAGE_SEQUENCE_EVICT_PLAYHEAD
+};
+static const char* replayPolicyNames[] = { "lru", "clock", "arc", "playhead" };
+
+struct ofxImageSequenceReplayResult {
+	int hits;
+	int misses;
+	uint64_t stallMicros;
+};
+
+//the decoded tier of every sequence of the trace under an eviction policy, filled on demand without
+//prefetching, so the stall time is an upper bound of what a show with the same budget would see
+static ofxImageSequenceReplayResult replayTrace(const ofxImageSequenceTrace& trace, uint64_t budget, ofxImageSequenceEviction eviction)
+{
+	struct Cache {
+		shared_ptr<ofxImageSequenceEvictionPolicy> policy;
+		ofxImageSequenceEvictionContext context;
+		set<int> resident;
+	};
+
+	ofxImageSequenceReplayResult result = { 0, 0, 0 };
+	const vector<ofxImageSequenceTrace::Request>& requests = trace.getRequests();
+	const map<int, ofxImageSequenceTrace::Sequence>& sequences = trace.getSequences();
+	map<int, Cache> caches;
+
+	for(int i = 0; i < requests.size(); i++){
+		const ofxImageSequenceTrace::Request& request = requests[i];
+		map<int, ofxImageSequenceTrace::Sequence>::const_iterator sequence = sequences.find(request.sequenceId);
+		if(sequence == sequences.end()){
+			continue;
+		}
+
+		Cache& cache = caches[request.sequenceId];
+		if(!cache.policy){
+			cache.policy = ofxImageSequenceCreateEvictionPolicy(eviction);
+			cache.context.playhead = request.frame;
+			cache.context.direction = 1;
+		}
+		if(request.frame != cache.context.playhead){
+			cache.context.direction = request.frame > cache.context.playhead ? 1 : -1;
+		}
+		cache.context.playhead = request.frame;
+		cache.context.numFrames = sequence->second.totalFrames;
+
+		if(cache.resident.count(request.frame) > 0){
+			result.hits++;
+			cache.policy->accessed(request.frame);
+			continue;
+		}
+
+		result.misses++;
+		uint64_t decodeMicros = trace.getMeanDecodeMicros(request.sequenceId);
+		result.stallMicros += decodeMicros > 0 ? decodeMicros : defaultMissMicros;
+
+		uint64_t frameBytes = MAX(sequence->second.frameBytes, (uint64_t)1);
+		cache.resident.insert(request.frame);
+		cache.policy->inserted(request.frame);
+		while(cache.resident.size() * frameBytes > budget){
+			int victim = cache.policy->selectVictim(cache.context);
+			if(victim == -1){
+				break;
+			}
+			cache.resident.erase(victim);
+			cache.policy->removed(victim);
+		}
+	}
+	return result;
+}
+
+//--------------------------------------------------------------
+ofApp::ofApp(){
+	outputPath = "simulation.json";
+}
+
+//--------------------------------------------------------------
+void ofApp::setup(){
+	stringstream json;
+	if(ofFilePath::getFileExt(folder) == "trace"){
+		replay(json, folder);
+	}
+	else{
+		if(folder.empty()){
+			folder = generateSequence(ofToDataPath("simulatorFrames", true));
+		}
+		trace.startRecording("simulation.trace");
+
+		json << "{\n";
+		json << "\t\"folder\": \"" << folder << "\",\n";
+		json << "\t\"refresh_rate\": " << refreshRate << ",\n";
+		json << "\t\"frame_rate\": " << sequenceFrameRate << ",\n";
+		json << "\t\"decoded_budget_frames\": " << decodedBudgetFrames << ",\n";
+		json << "\t\"compressed_budget_bytes\": " << compressedBudgetBytes << ",\n";
+		json << "\t\"patterns\": [\n";
+		for(int i = 0; i < SIMULATOR_NUM_PATTERNS; i++){
+			simulate(json, (ofxImageSequenceSimulatorPattern)i);
+			json << (i + 1 < SIMULATOR_NUM_PATTERNS ? ",\n" : "\n");
+		}
+		json << "\t],\n";
+		json << "\t\"group\": ";
+		simulateGroup(json);
+		json << "\n}\n";
+
+		trace.stopRecording();
+	}
+
+	ofstream file(ofToDataPath(outputPath).c_str());
+	file << json.str();
+	ofLogNotice("ofApp") << "Simulation results written to " << ofToDataPath(outputPath, true);
+
+	ofExit();
+}
+
+//--------------------------------------------------------------
+//ten seconds of 1080p jpgs, a moving gradient with some noise, kept for the next runs
+string ofApp::generateSequence(string path){
+	if(ofDirectory::doesDirectoryExist(path, false)){
+		return path;
+	}
+	ofDirectory::createDirectory(path, false, true);
+	ofLogNotice("ofApp") << "Generating a synthetic sequence in " << path;
+
+	int width = 1920;
+	int height = 1080;
+	ofPixels pixels;
+	pixels.allocate(width, height, OF_PIXELS_RGB);
+	unsigned int seed = 1;
+	for(int f = 0; f < 10 * sequenceFrameRate; f++){
+		unsigned char* data = pixels.getData();
+		for(int y = 0; y < height; y++){
+			for(int x = 0; x < width; x++){
+				seed = seed * 1664525u + 1013904223u;
+				unsigned char* pixel = data + (y * width + x) * 3;
+				pixel[0] = x + f * 4;
+				pixel[1] = y + f * 2;
+				pixel[2] = ((x ^ y) & 0xe0) + (seed >> 27);
+			}
+		}
+		ofSaveImage(pixels, ofFilePath::join(path, "frame" + ofToString(f, 5, '0') + ".jpg"), OF_IMAGE_QUALITY_HIGH);
+	}
+	return path;
+}
+
+//--------------------------------------------------------------
+//the sequence time asked for at every vsync
+void ofApp::buildTimeline(ofxImageSequenceSimulatorPattern pattern, float length, vector<float>& times){
+	int ticks = secondsPerPattern * refreshRate;
+	float interval = 1.0f / refreshRate;
+	if(pattern == SIMULATOR_LINEAR){
+		ticks = MIN(ticks, (int)(length * refreshRate));
+	}
+
+	times.clear();
+	ofSeedRandom(pattern);	//the same timeline on every run
+	float time = 0;
+	float speed = 1.0f;
+	float nextCue = 2.0f;
+	for(int tick = 0; tick < ticks; tick++){
+		float clock = tick * interval;
+		switch(pattern){
+			case SIMULATOR_LINEAR:
+			case SIMULATOR_LOOP:
+				time = clock;
+				break;
+			case SIMULATOR_PING_PONG:
+				time = length - fabs(fmodf(clock, 2 * length) - length);
+				break;
+			case SIMULATOR_SCRUB:
+				//the speed drifts between 4x backwards and 4x forwards
+				speed = ofClamp(speed + ofRandom(-0.4f, 0.4f), -4.0f, 4.0f);
+				time += speed * interval;
+				break;
+			case SIMULATOR_CUES:
+				time += interval;
+				if(clock >= nextCue){
+					time = ofRandom(length);
+					nextCue = clock + ofRandom(1.0f, 4.0f);
+				}
+				break;
+			default:
+				break;
+		}
+		//setFrameForTime takes times past either end as wrapping around
+		times.push_back(fmodf(fmodf(time, length) + length, length));
+	}
+}
+
+//--------------------------------------------------------------
+//one pattern on a freshly loaded sequence, paced on the real clock
+void ofApp::simulate(ostream& json, ofxImageSequenceSimulatorPattern pattern){
+	ofLogNotice("ofApp") << "Simulating " << patternNames[pattern];
+
+	ofxImageSequence sequence;
+	sequence.setUseTexture(false);
+	sequence.setFrameRate(sequenceFrameRate);
+	sequence.setOutputFrameRate(refreshRate);
+	sequence.setTierBudget(OFX_IMAGE_SEQUENCE_TIER_COMPRESSED, compressedBudgetBytes);
+	if(maxQualityLevel > 0){
+		sequence.enableAdaptiveQuality(true, maxQualityLevel);
+	}
+	sequence.setEvictionPolicy(eviction);
+	sequence.setTrace(&trace, pattern);
+	if(!sequence.loadSequence(folder)){
+		json << "\t\t{\"pattern\": \"" << patternNames[pattern] << "\", \"error\": \"load failed\"}";
+		return;
+	}
+	//the frame size is only known once the first frame is decoded
+	shared_ptr<const ofPixels> first = sequence.getPixelsForFrame(0);
+	if(decodedBudgetFrames > 0 && first){
+		sequence.setTierBudget(OFX_IMAGE_SEQUENCE_TIER_DECODED, first->size() * decodedBudgetFrames);
+	}
+
+	vector<float> times;
+	buildTimeline(pattern, sequence.getLengthInSeconds(), times);
+
+	vector<double> latencyMillis;
+	int cacheMisses = 0;
+	int deadlineMisses = 0;
+	int droppedVsyncs = 0;
+	float interval = 1.0f / refreshRate;
+	std::chrono::steady_clock::time_point vsync = std::chrono::steady_clock::now();
+	std::chrono::microseconds vsyncInterval((int64_t)(interval * 1000000));
+
+	for(int tick = 0; tick < times.size(); tick++){
+		int frame = sequence.getFrameIndexAtPercent(times[tick] / sequence.getLengthInSeconds());
+		if(!sequence.isFrameReady(frame)){
+			cacheMisses++;
+		}
+
+		uint64_t start = ofGetElapsedTimeMicros();
+		sequence.setFrameForTime(times[tick]);
+		double millis = (ofGetElapsedTimeMicros() - start) / 1000.0;
+		latencyMillis.push_back(millis);
+
+		//an overrun frame is shown late and the vsyncs it overran are never presented
+		if(millis > interval * 1000.0){
+			int overrun = (int)(millis / (interval * 1000.0));
+			deadlineMisses++;
+			droppedVsyncs += overrun;
+			tick += overrun;
+			vsync += vsyncInterval * overrun;
+		}
+		vsync += vsyncInterval;
+		std::this_thread::sleep_until(vsync);
+	}
+
+	json << "\t\t{\"pattern\": \"" << patternNames[pattern] << "\", \"vsyncs\": " << times.size()
+		 << ", \"presented\": " << latencyMillis.size()
+		 << ", \"cache_misses\": " << cacheMisses
+		 << ", \"deadline_misses\": " << deadlineMisses
+		 << ", \"dropped_vsyncs\": " << droppedVsyncs
+		 << ", \"quality_level\": " << sequence.getQualityLevel()
+		 << ",\n\t\t \"latency_ms\": ";
+	writeTimings(json, latencyMillis);
+	json << "}";
+}
+
+//--------------------------------------------------------------
+//two members in lock step, paced on the real clock so the group's maximum wait runs out
+void ofApp::simulateGroup(ostream& json){
+	ofLogNotice("ofApp") << "Simulating a group at " << groupSpeed << "x";
+
+	ofxImageSequence members[2];
+	ofxImageSequenceGroup group;
+	for(int i = 0; i < 2; i++){
+		members[i].setUseTexture(false);
+		members[i].setFrameRate(sequenceFrameRate);
+		if(!members[i].loadSequence(folder)){
+			json << "{\"error\": \"load failed\"}";
+			return;
+		}
+		group.addSequence(&members[i]);
+	}
+	group.setFrameRate(sequenceFrameRate);
+	group.setPrefetchFrames(groupPrefetchFrames);
+	group.setMaxWait(groupMaxWait);
+
+	int ticks = secondsPerPattern * refreshRate;
+	float interval = 1.0f / refreshRate;
+	int presented = 0;
+	int lastFrame = -1;
+	float lastPresent = ofGetElapsedTimef();
+	float longestHold = 0;
+	std::chrono::steady_clock::time_point vsync = std::chrono::steady_clock::now();
+	std::chrono::microseconds vsyncInterval((int64_t)(interval * 1000000));
+
+	for(int tick = 0; tick < ticks; tick++){
+		group.setFrameForTime(tick * interval * groupSpeed);
+		float now = ofGetElapsedTimef();
+		if(group.getCurrentFrame() != lastFrame){
+			lastFrame = group.getCurrentFrame();
+			presented++;
+			lastPresent = now;
+		}
+		longestHold = MAX(longestHold, now - lastPresent);
+		vsync += vsyncInterval;
+		std::this_thread::sleep_until(vsync);
+	}
+
+	json << "{\"speed\": " << groupSpeed << ", \"max_wait\": " << groupMaxWait
+		 << ", \"vsyncs\": " << ticks
+		 << ", \"presented\": " << presented
+		 << ", \"synchronous_loads\": " << group.getSynchronousLoads()
+		 << ", \"longest_hold_ms\": " << longestHold * 1000.0 << "}";
+}
+
+//--------------------------------------------------------------
+//every policy at every budget, on the requests as they were recorded
+void ofApp::replay(ostream& json, string tracePath){
+	ofLogNotice("ofApp") << "Replaying " << tracePath;
+	json << "{\n";
+	json << "\t\"trace\": \"" << tracePath << "\",\n";
+	if(!trace.load(tracePath)){
+		json << "\t\"error\": \"load failed\"\n}\n";
+		return;
+	}
+
+	const vector<ofxImageSequenceTrace::Request>& requests = trace.getRequests();
+	json << "\t\"requests\": " << requests.size() << ",\n";
+	json << "\t\"seconds\": " << (requests.empty() ? 0 : requests.back().micros / 1000000.0) << ",\n";
+	json << "\t\"sequences\": " << trace.getSequences().size() << ",\n";
+	json << "\t\"results\": [\n";
+	int numBudgets = sizeof(replayBudgets) / sizeof(replayBudgets[0]);
+	int numPolicies = sizeof(replayPolicies) / sizeof(replayPolicies[0]);
+	for(int p = 0; p < numPolicies; p++){
+		for(int b = 0; b < numBudgets; b++){
+			ofxImageSequenceReplayResult result = replayTrace(trace, replayBudgets[b], replayPolicies[p]);
+			json << "\t\t{\"policy\": \"" << replayPolicyNames[p] << "\", \"budget_bytes\": " << replayBudgets[b]
+				 << ", \"hit_rate\": " << (requests.empty() ? 0 : (double)result.hits / requests.size())
+				 << ", \"misses\": " << result.misses
+				 << ", \"stall_ms\": " << result.stallMicros / 1000.0 << "}";
+			json << (p + 1 < numPolicies || b + 1 < numBudgets ? ",\n" : "\n");
+		}
+	}
+	json << "\t]\n";
+	json << "}\n";
+}
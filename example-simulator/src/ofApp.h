@@ -0,0 +1,62 @@
+/**
+ *  ofApp.h
+ *
+ *	ofxImageSequence playback simulator
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  Headless end to end playback. A virtual vsync clock calls setFrameForTime once per refresh
+ *  following a playback pattern, in real time so the background loaders get the time they would
+ *  have in a show. For every pattern it reports setFrame latency percentiles, cache misses (frames
+ *  not ready when asked for) and deadline misses (calls longer than the refresh interval, each
+ *  dropping the vsyncs it overran). Frames are never uploaded, so no display or GPU is needed and
+ *  prefetch and cache settings can be compared on any machine.
+ *
+ *  The requests of every run are recorded to bin/data/simulation.trace. Passing a .trace file instead
+ *  of a folder replays it offline, recorded here or in a show with ofxImageSequenceTrace, against a
+ *  range of decoded tier budgets under each eviction policy, reporting hit rates and the time stalled
+ *  on misses.
+ *
+ *  A last run plays two copies of the sequence in lock step through ofxImageSequenceGroup, faster
+ *  than they can be decoded with a short prefetch, so the group keeps falling behind. It reports
+ *  how often the maximum wait ran out and frames were loaded synchronously, and the longest time
+ *  the group held a frame, which should stay close to the maximum wait.
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxImageSequence.h"
+#include "ofxImageSequenceGroup.h"
+
+enum ofxImageSequenceSimulatorPattern {
+	SIMULATOR_LINEAR = 0,	//plays once from the start
+	SIMULATOR_LOOP,			//plays on, wrapping around the end
+	SIMULATOR_PING_PONG,	//forwards then backwards
+	SIMULATOR_SCRUB,		//a hand on a jog wheel, speeding up, slowing down and reversing
+	SIMULATOR_CUES,			//plays, jumping to a random point every few seconds
+	SIMULATOR_NUM_PATTERNS
+};
+
+class ofApp : public ofBaseApp
+{
+
+  public:
+	ofApp();
+
+	void setup();
+
+	string folder;
+	string outputPath;
+
+  protected:
+	string generateSequence(string path);
+	void buildTimeline(ofxImageSequenceSimulatorPattern pattern, float length, vector<float>& times);
+	void simulate(ostream& json, ofxImageSequenceSimulatorPattern pattern);
+	void simulateGroup(ostream& json);
+	void replay(ostream& json, string tracePath);
+
+	ofxImageSequenceTrace trace;
+};
@@ -49,6 +49,9 @@ void ofApp::setup(){
 	sequence.loadSequence("frames");
 
 	//sequence.setFrameRate(10); //set to ten frames per second for Muybridge's horse.
+
+	//shows which frames are loaded while the thread works through them
+	overlay.addSequence(&sequence, "frames");
 	
 	playing = false; //controls if playing automatically, or controlled by the mouse
 }
@@ -78,6 +81,8 @@ void ofApp::draw(){
 			sequence.getFrameAtPercent(percent)->draw(0, 0);
 		}
 	}
+
+	overlay.draw(10, ofGetHeight() - overlay.getHeight() - 10, ofGetWidth() - 20);
 }
 
 //--------------------------------------------------------------
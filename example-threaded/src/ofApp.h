@@ -13,6 +13,7 @@
 
 #include "ofMain.h"
 #include "ofxImageSequence.h"
+#include "ofxImageSequenceOverlay.h"
 
 class ofApp : public ofBaseApp
 {
@@ -31,6 +32,7 @@ class ofApp : public ofBaseApp
 	void windowResized(int w, int h);
 	
 	ofxImageSequence sequence;
+	ofxImageSequenceOverlay overlay;
 	ofImage background;
 	bool playing;
 };
@@ -107,6 +107,234 @@ class ofxImageSequenceLoader : public ofThread
 
 };
 
+//promotes and demotes frames in the RAM tiers from a background thread, woken whenever the playhead moves
+class ofxImageSequenceTierManager : public ofThread
+{
+  public:
+
+	ofxImageSequence& sequenceRef;
+	std::condition_variable wake;
+	std::mutex workMutex;	//held while a frame is being promoted or demoted
+	bool dirty;
+
+	ofxImageSequenceTierManager(ofxImageSequence* seq)
+	: sequenceRef(*seq)
+	, dirty(true)
+	{
+		startThread(true);
+	}
+
+	~ofxImageSequenceTierManager(){
+		stop();
+	}
+
+	void notify(){
+		lock();
+		dirty = true;
+		unlock();
+		wake.notify_one();
+	}
+
+	void stop(){
+		if(isThreadRunning()){
+			stopThread();
+			wake.notify_one();
+			waitForThread(false);
+		}
+	}
+
+	void threadedFunction(){
+		while(isThreadRunning()){
+			workMutex.lock();
+			bool worked = sequenceRef.updateTiers();
+			workMutex.unlock();
+			if(worked){
+				continue;
+			}
+			std::unique_lock<std::mutex> lck(mutex);
+			if(!dirty){
+				wake.wait_for(lck, std::chrono::milliseconds(100));
+			}
+			dirty = false;
+		}
+	}
+
+};
+
+//scans and decodes the first frames of a sequence being prepared for a swap
+class ofxImageSequencePreparer : public ofThread
+{
+  public:
+
+	ofxImageSequence& sequenceRef;
+	int framesToPrime;
+	std::atomic<bool> done;
+	std::atomic<bool> failed;
+
+	ofxImageSequencePreparer(ofxImageSequence* seq, int frames)
+	: sequenceRef(*seq)
+	, framesToPrime(frames)
+	, done(false)
+	, failed(false)
+	{
+		startThread(true);
+	}
+
+	~ofxImageSequencePreparer(){
+		waitForThread(true);
+	}
+
+	void threadedFunction(){
+		if(!sequenceRef.preloadAllFilenames()){
+			failed = true;
+			done = true;
+			return;
+		}
+		for(int i = 0; i < MIN(framesToPrime, sequenceRef.getTotalFrames()) && isThreadRunning(); i++){
+			sequenceRef.acquirePixels(i, true);
+		}
+		done = true;
+	}
+
+};
+
+//frames of a sequence swapped out, freed on the releaser thread since that can take a while
+struct ofxImageSequenceReleasedFrames {
+	vector< shared_ptr<const ofPixels> > pixels;
+	vector< shared_ptr<ofxImageSequenceLinearFrame> > linearFrames;
+	vector< shared_ptr<ofBuffer> > compressed;
+};
+
+//shared state of a forEachFrame call. frames are handed out in increasing order, so in ordered mode
+//the next frame to deliver is always held by a worker and waiting never deadlocks
+struct ofxImageSequenceFrameJob
+{
+	ofxImageSequence* sequence;
+	function<void(int, const ofPixels&)> fn;
+	bool ordered;
+	int total;
+	std::atomic<int> nextFrame;
+	int nextDelivery;
+	std::mutex mutex;
+	std::condition_variable delivered;
+
+	ofxImageSequenceFrameJob(ofxImageSequence* seq, function<void(int, const ofPixels&)> _fn, bool _ordered)
+	: sequence(seq)
+	, fn(_fn)
+	, ordered(_ordered)
+	, total(seq->getTotalFrames())
+	, nextFrame(0)
+	, nextDelivery(0)
+	{
+	}
+};
+
+class ofxImageSequenceFrameWorker : public ofThread
+{
+  public:
+
+	ofxImageSequenceFrameJob& job;
+
+	ofxImageSequenceFrameWorker(ofxImageSequenceFrameJob& _job)
+	: job(_job)
+	{
+		startThread(true);
+	}
+
+	void threadedFunction(){
+		while(true){
+			int index = job.nextFrame++;
+			if(index >= job.total){
+				break;
+			}
+
+			shared_ptr<const ofPixels> pixels = job.sequence->acquirePixels(index, false);
+
+			if(job.ordered){
+				std::unique_lock<std::mutex> lck(job.mutex);
+				job.delivered.wait(lck, [&]{ return job.nextDelivery == index; });
+			}
+
+			if(pixels){
+				job.fn(index, *pixels);
+			}
+
+			if(job.ordered){
+				job.mutex.lock();
+				job.nextDelivery++;
+				job.mutex.unlock();
+				job.delivered.notify_all();
+			}
+		}
+	}
+
+};
+
+//shared state of a processFrames call. workers stall once they get reorderFrames ahead of the sink
+struct ofxImageSequencePipelineJob
+{
+	ofxImageSequence* sequence;
+	function<void(int, const ofPixels&, ofPixels&)> process;
+	int total;
+	int window;
+	int nextFrame;
+	int nextSink;
+	map<int, shared_ptr<ofPixels> > results;	//empty pointer for frames that failed
+	std::mutex mutex;
+	std::condition_variable changed;
+
+	ofxImageSequencePipelineJob(ofxImageSequence* seq, function<void(int, const ofPixels&, ofPixels&)> _process, int _window)
+	: sequence(seq)
+	, process(_process)
+	, total(seq->getTotalFrames())
+	, window(_window)
+	, nextFrame(0)
+	, nextSink(0)
+	{
+	}
+};
+
+class ofxImageSequencePipelineWorker : public ofThread
+{
+  public:
+
+	ofxImageSequencePipelineJob& job;
+
+	ofxImageSequencePipelineWorker(ofxImageSequencePipelineJob& _job)
+	: job(_job)
+	{
+		startThread(true);
+	}
+
+	void threadedFunction(){
+		while(true){
+			int index;
+			{
+				std::unique_lock<std::mutex> lck(job.mutex);
+				job.changed.wait(lck, [&]{ return job.nextFrame >= job.total || job.nextFrame < job.nextSink + job.window; });
+				if(job.nextFrame >= job.total){
+					break;
+				}
+				index = job.nextFrame++;
+			}
+
+			shared_ptr<ofPixels> output;
+			shared_ptr<const ofPixels> input = job.sequence->acquirePixels(index, false);
+			if(input){
+				output = shared_ptr<ofPixels>(new ofPixels());
+				job.process(index, *input, *output);
+			}
+			input.reset();
+
+			job.mutex.lock();
+			job.results[index] = output;
+			job.mutex.unlock();
+			job.changed.notify_all();
+		}
+	}
+
+};
+
 ofxImageSequence::ofxImageSequence()
 {
 	loaded = false;
@@ -116,12 +344,55 @@ ofxImageSequence::ofxImageSequence()
 	currentFrame = 0;
 	maxFrames = 0;
 	curLoadFrame = 0;
+	useTexture = true;
+	width = 0;
+	height = 0;
+	minFilter = 0;
+	magFilter = 0;
 	threadLoader = NULL;
+	tierManager = NULL;
+	preparer = NULL;
+	prepared = NULL;
+	swapPending = false;
+
+	for(int i = 0; i < OFX_IMAGE_SEQUENCE_NUM_TIERS; i++){
+		tierBudgets[i] = 0;
+		tierBytes[i] = 0;
+		tierFrameCounts[i] = 0;
+	}
+	tierBudgets[OFX_IMAGE_SEQUENCE_TIER_SOURCE] = OFX_IMAGE_SEQUENCE_UNLIMITED;
+	tierBudgets[OFX_IMAGE_SEQUENCE_TIER_DECODED] = OFX_IMAGE_SEQUENCE_UNLIMITED;
+	decodedFrameBytes = 0;
+	frameSizeEstimated = false;
+	maxUploadsPerFrame = 1;
+	tierPlayhead = 0;
+	playDirection = 1;
+	targetWidth = 0;
+	targetHeight = 0;
+	targetFilter = OFX_IMAGE_SEQUENCE_FILTER_LANCZOS;
+	colorOutput = OFX_IMAGE_SEQUENCE_COLOR_SRGB;
+	sharedCache = NULL;
+	trace = NULL;
+	traceId = 0;
+	pinnedBudget = OFX_IMAGE_SEQUENCE_UNLIMITED;
+	pinnedBytes = 0;
+	resetStats();
+	outputFrameRate = 0;
+	playbackSpeed = 1.0f;
+	frameStride = 1.0f;
+	adaptiveQuality = false;
+	qualityLevel = 0;
+	maxQualityLevel = 2;
+	averageLoadMicros = 0;
+	framesSinceQualityChange = 0;
 }
 
 ofxImageSequence::~ofxImageSequence()
 {
 	unloadSequence();
+	if(releaser.joinable()){
+		releaser.join();
+	}
 }
 
 bool ofxImageSequence::loadSequence(string prefix, string filetype,  int startDigit, int endDigit)
@@ -149,21 +420,43 @@ bool ofxImageSequence::loadSequence(string prefix, string filetype,  int startDi
 	
 	for(int i = startDigit; i <= endDigit; i++){
 		sprintf(imagename, format.str().c_str(), i);
-		filenames.push_back(imagename);
-		sequence.push_back(ofPixels());
-		loadFailed.push_back(false);
+		addFrame(imagename);
 	}
 	
 	loaded = true;
 	
 	lastFrameLoaded = -1;
 	loadFrame(0);
-	
-	width  = sequence[0].getWidth();
-	height = sequence[0].getHeight();
+	startTierManager();
 	return true;
 }
 
+bool ofxImageSequence::loadSequence(const ofxImageSequencePattern& pattern)
+{
+	unloadSequence();
+
+	if(!pattern.isValid()){
+		ofLogError("ofxImageSequence::loadSequence") << "Invalid sequence pattern.";
+		return false;
+	}
+
+	vector< pair<int, int> >::const_iterator gap = pattern.gaps.begin();
+	for(int i = pattern.startIndex; i <= pattern.endIndex; i++){
+		if(maxFrames > 0 && filenames.size() >= maxFrames){
+			break;
+		}
+		if(gap != pattern.gaps.end() && i >= gap->first){
+			i = gap->second;
+			++gap;
+			continue;
+		}
+		addFrame(pattern.getPath(i));
+	}
+
+	completeLoading();
+	return loaded;
+}
+
 bool ofxImageSequence::loadSequence(string _folder)
 {
 	unloadSequence();
@@ -195,10 +488,7 @@ void ofxImageSequence::completeLoading()
 	loaded = true;	
 	lastFrameLoaded = -1;
 	loadFrame(0);
-	
-	width  = sequence[0].getWidth();
-	height = sequence[0].getHeight();
-
+	startTierManager();
 }
 
 bool ofxImageSequence::preloadAllFilenames()
@@ -234,13 +524,20 @@ bool ofxImageSequence::preloadAllFilenames()
 
 	for(int i = 0; i < numFiles; i++) {
 
-        filenames.push_back(dir.getPath(i));
-		sequence.push_back(ofPixels());
-		loadFailed.push_back(false);
+        addFrame(dir.getPath(i));
     }
 	return true;
 }
 
+void ofxImageSequence::addFrame(string path)
+{
+	filenames.push_back(path);
+	sequence.push_back(shared_ptr<ofPixels>());
+	linearFrames.push_back(shared_ptr<ofxImageSequenceLinearFrame>());
+	compressed.push_back(shared_ptr<ofBuffer>());
+	frameStates.push_back(0);
+}
+
 //set to limit the number of frames. negative means no limit
 void ofxImageSequence::setMaxFrames(int newMaxFrames)
 {
@@ -273,11 +570,69 @@ void ofxImageSequence::cancelLoad()
 	}
 }
 
+bool ofxImageSequence::loadColorLut(string cubePath)
+{
+	ofxImageSequenceColorLut lut;
+	if(!lut.load(cubePath)){
+		return false;
+	}
+	setColorLut(lut);
+	return true;
+}
+
+void ofxImageSequence::setColorLut(const ofxImageSequenceColorLut& lut)
+{
+	if(loaded || isLoading()){
+		ofLogWarning("ofxImageSequence::setColorLut") << "Frames already loaded are not graded, set the LUT before loading";
+	}
+	colorLut = lut;
+}
+
+void ofxImageSequence::clearColorLut()
+{
+	colorLut.clear();
+}
+
+void ofxImageSequence::setFrameProcessor(function<void(ofPixels&, int)> fn)
+{
+	if(loaded || isLoading()){
+		ofLogWarning("ofxImageSequence::setFrameProcessor") << "Frames already loaded are not processed, set the processor before loading";
+	}
+	frameProcessor = fn;
+}
+
+//frames already decoded are converted as they upload until they are decoded again
+void ofxImageSequence::setColorOutput(ofxImageSequenceColorOutput output)
+{
+	colorOutput = output;
+}
+
+ofxImageSequenceColorOutput ofxImageSequence::getColorOutput()
+{
+	return colorOutput;
+}
+
+void ofxImageSequence::setTargetSize(int w, int h, ofxImageSequenceFilter filter)
+{
+	if(loaded || isLoading()){
+		ofLogWarning("ofxImageSequence::setTargetSize") << "Frames already loaded keep their size, set the target size before loading";
+	}
+	targetWidth = MAX(w, 0);
+	targetHeight = MAX(h, 0);
+	targetFilter = filter;
+}
+
 void ofxImageSequence::setMinMagFilter(int newMinFilter, int newMagFilter)
 {
 	minFilter = newMinFilter;
 	magFilter = newMagFilter;
+	if(!useTexture){
+		return;
+	}
 	texture.setTextureMinMagFilter(minFilter, magFilter);
+	for(map<int, ofTexture>::iterator it = residentTextures.begin(); it != residentTextures.end(); ++it){
+		it->second.setTextureMinMagFilter(minFilter, magFilter);
+	}
 }
 
 void ofxImageSequence::preloadAllFrames()
@@ -287,7 +642,9 @@ void ofxImageSequence::preloadAllFrames()
 		return;
 	}
 	
-	for(int i = 0; i < sequence.size(); i++){
+	for(int presented = 0; getStrideOffset(presented) < sequence.size(); presented++){
+		int i = getStrideOffset(presented);
+
 		//threaded stuff
 		if(useThread){
 			if(threadLoader == NULL){
@@ -303,10 +660,74 @@ void ofxImageSequence::preloadAllFrames()
 			ofSleepMillis(15);
 		}
 		curLoadFrame = i;
-		if(!ofLoadImage(sequence[i], filenames[i])){
-			loadFailed[i] = true;
-			ofLogError("ofxImageSequence::loadFrame") << "Image failed to load: " << filenames[i];		
+
+		frameMutex.lock();
+		bool needsDecode = !sequence[i] && !isFrameFailed(i);
+		bool full = !hasTierRoom(OFX_IMAGE_SEQUENCE_TIER_DECODED, getTierFrameBytes(OFX_IMAGE_SEQUENCE_TIER_DECODED));
+		frameMutex.unlock();
+
+		if(full){
+			ofLogNotice("ofxImageSequence::preloadAllFrames") << "Decoded tier budget reached after " << i << " frames";
+			return;
+		}
+		if(!needsDecode){
+			continue;
+		}
+
+		shared_ptr<const ofPixels> pixels = decodePixels(i, 0);
+		if(pixels){
+			storeDecodedFrame(i, pixels, 0);
+		}
+		else{
+			markFrameFailed(i);
+		}
+	}
+}
+
+void ofxImageSequence::processFrames(function<void(int, const ofPixels&, ofPixels&)> process,
+									 function<void(int, ofPixels&)> sink,
+									 int numThreads, int reorderFrames)
+{
+	if(filenames.empty()){
+		ofLogError("ofxImageSequence::processFrames") << "Calling processFrames on unitialized image sequence.";
+		return;
+	}
+
+	if(numThreads <= 0){
+		numThreads = MAX((int)std::thread::hardware_concurrency(), 1);
+	}
+	if(reorderFrames <= 0){
+		reorderFrames = numThreads * 2;
+	}
+
+	ofxImageSequencePipelineJob job(this, process, reorderFrames);
+	vector< shared_ptr<ofxImageSequencePipelineWorker> > workers;
+	for(int i = 0; i < MIN(numThreads, getTotalFrames()); i++){
+		workers.push_back(shared_ptr<ofxImageSequencePipelineWorker>(new ofxImageSequencePipelineWorker(job)));
+	}
+
+	//drain the reorder buffer in frame order
+	while(job.nextSink < job.total){
+		shared_ptr<ofPixels> output;
+		{
+			std::unique_lock<std::mutex> lck(job.mutex);
+			job.changed.wait(lck, [&]{ return job.results.count(job.nextSink) > 0; });
+			output = job.results[job.nextSink];
+			job.results.erase(job.nextSink);
+		}
+
+		if(output){
+			sink(job.nextSink, *output);
 		}
+
+		job.mutex.lock();
+		job.nextSink++;
+		job.mutex.unlock();
+		job.changed.notify_all();
+	}
+
+	for(int i = 0; i < workers.size(); i++){
+		workers[i]->waitForThread(false);
 	}
 }
 
@@ -331,106 +752,1634 @@ void ofxImageSequence::loadFrame(int imageIndex)
 		return;
 	}
 
-	if(!sequence[imageIndex].isAllocated() && !loadFailed[imageIndex]){
-		if(!ofLoadImage(sequence[imageIndex], filenames[imageIndex])){
-			loadFailed[imageIndex] = true;
-			ofLogError("ofxImageSequence::loadFrame") << "Image failed to load: " << filenames[imageIndex];
+	uint64_t startMicros = ofGetElapsedTimeMicros();
+	int level = qualityLevel;
+
+	frameMutex.lock();
+	bool failed = isFrameFailed(imageIndex);
+	bool resident = (frameStates[imageIndex] & (1 << OFX_IMAGE_SEQUENCE_TIER_GPU)) != 0;
+	shared_ptr<const ofPixels> pixels = sequence[imageIndex];
+	shared_ptr<ofxImageSequenceLinearFrame> linear = linearFrames[imageIndex];
+	if(pixels && getFrameLevel(imageIndex) > level){
+		pixels.reset(); //decoded while degraded, there is headroom for a sharper one now
+		linear.reset();
+	}
+	if(pixels && evictionPolicy){
+		evictionPolicy->accessed(imageIndex);
+	}
+	//a pinned proxy is shown right away while the full frame is fetched
+	bool fetch = false;
+	map<int, PinnedFrame>::iterator pin = pinnedFrames.find(imageIndex);
+	if(!pixels && !resident && pin != pinnedFrames.end() && pin->second.pixels){
+		pixels = pin->second.pixels;
+		linear = pin->second.linear;
+		if(pin->second.level > level){
+			prefetchQueue.push_back(imageIndex);
+			frameStates[imageIndex] |= FRAME_QUEUED;
+			fetch = true;
 		}
 	}
+	frameMutex.unlock();
 
-	if(loadFailed[imageIndex]){
+	if(fetch){
+		wakeTierManager();
+	}
+	if(failed){
 		return;
 	}
 
-	texture.loadData(sequence[imageIndex]);
+	if(resident || pixels){
+		numHits++;
+	}
+	else{
+		numMisses++;
+	}
+
+	bool decoded = false;
+	if(!resident){
+		if(!pixels){
+			decoded = true;
+			pixels = decodePixels(imageIndex, level);
+			if(!pixels){
+				markFrameFailed(imageIndex);
+				return;
+			}
+			if(trace != NULL){
+				trace->recordDecode(traceId, ofGetElapsedTimeMicros() - startMicros);
+			}
+			linear = storeDecodedFrame(imageIndex, pixels, level);
+		}
+		if(useTexture){
+			uploadPixels(texture, *pixels, linear);
+		}
+	}
 
 	lastFrameLoaded = imageIndex;
 
+	//cache hits say nothing about whether decoding keeps up
+	if(decoded){
+		updateQualityLevel(ofGetElapsedTimeMicros() - startMicros);
+	}
 }
 
-float ofxImageSequence::getPercentAtFrameIndex(int index)
+void ofxImageSequence::prefetchFrames(int startIndex, int count)
 {
-	return ofMap(index, 0, sequence.size()-1, 0, 1.0, true);
-}
+	int total = getTotalFrames();
+	if(!loaded || total == 0 || count == 0){
+		return;
+	}
 
-float ofxImageSequence::getWidth()
-{
-	return width;
-}
+	int direction = count > 0 ? 1 : -1;
+	frameMutex.lock();
+	tierPlayhead = (startIndex % total + total) % total;
+	playDirection = direction;
+	for(int i = 0; i < MIN(abs(count), total) && getStrideOffset(i) < total; i++){
+		int frame = ((startIndex + getStrideOffset(i)*direction) % total + total) % total;
+		prefetchQueue.push_back(frame);
+		frameStates[frame] |= FRAME_QUEUED;
+	}
+	frameMutex.unlock();
 
-float ofxImageSequence::getHeight()
-{
-	return height;
+	wakeTierManager();
 }
 
-void ofxImageSequence::unloadSequence()
+//starts the tier manager for explicit work even when no tier is bounded
+void ofxImageSequence::wakeTierManager()
 {
-	if(threadLoader != NULL){
-		delete threadLoader;
-		threadLoader = NULL;
+	if(tierManager == NULL){
+		tierManager = new ofxImageSequenceTierManager(this);
+	}
+	else{
+		tierManager->notify();
 	}
-
-	sequence.clear();
-	filenames.clear();
-	loadFailed.clear();
-
-	loaded = false;
-	width = 0;
-	height = 0;
-	curLoadFrame = 0;
-	lastFrameLoaded = -1;
-	currentFrame = 0;	
-
 }
 
-void ofxImageSequence::setFrameRate(float rate)
+void ofxImageSequence::pinFrames(int startIndex, int count, int level)
 {
-	frameRate = rate;
-}
-
-string ofxImageSequence::getFilePath(int index){
-	if(index > 0 && index < filenames.size()){
-		return filenames[index];
+	int total = getTotalFrames();
+	if(!loaded || total == 0){
+		ofLogError("ofxImageSequence::pinFrames") << "Pin frames after loading the sequence";
+		return;
 	}
-	ofLogError("ofxImageSequence::getFilePath") << "Getting filename outside of range";
-	return "";
-}
+	level = MIN(MAX(level, 0), 3);
 
-int ofxImageSequence::getFrameIndexAtPercent(float percent)
-{
-    if (percent < 0.0 || percent > 1.0) percent -= floor(percent);
+	int refused = 0;
+	frameMutex.lock();
+	for(int i = MAX(startIndex, 0); i < MIN(startIndex + count, total); i++){
+		if(pinnedFrames.count(i) > 0){
+			continue;
+		}
+		PinnedFrame pin;
+		pin.level = level;
+		pin.bytes = getTierFrameBytes(OFX_IMAGE_SEQUENCE_TIER_DECODED) >> (2 * level);
+		//a frame already decoded at least as sharp is pinned as it is
+		if(sequence[i] && getFrameLevel(i) <= level){
+			pin.pixels = sequence[i];
+			pin.linear = linearFrames[i];
+			pin.bytes = getDecodedBytes(i);
+		}
+		if(pinnedBudget != OFX_IMAGE_SEQUENCE_UNLIMITED && pinnedBytes + pin.bytes > pinnedBudget){
+			refused++;
+			continue;
+		}
+		pinnedFrames[i] = pin;
+		pinnedBytes += pin.bytes;
+		frameStates[i] |= pin.pixels ? FRAME_PINNED : FRAME_PIN_PENDING;
+	}
+	frameMutex.unlock();
 
-	return MIN((int)(percent*sequence.size()), sequence.size()-1);
+	if(refused > 0){
+		ofLogWarning("ofxImageSequence::pinFrames") << "Pinned budget reached, " << refused << " frames were not pinned";
+	}
+	wakeTierManager();
 }
 
-//deprecated
-ofTexture& ofxImageSequence::getTextureReference()
+void ofxImageSequence::unpinFrames(int startIndex, int count)
 {
-	return getTexture();
+	ofScopedLock lock(frameMutex);
+	for(int i = MAX(startIndex, 0); i < startIndex + count; i++){
+		map<int, PinnedFrame>::iterator pin = pinnedFrames.find(i);
+		if(pin != pinnedFrames.end()){
+			pinnedBytes -= MIN(pin->second.bytes, pinnedBytes);
+			pinnedFrames.erase(pin);
+			frameStates[i] &= ~(FRAME_PINNED | FRAME_PIN_PENDING);
+		}
+	}
 }
 
-//deprecated
-ofTexture* ofxImageSequence::getFrameAtPercent(float percent)
+bool ofxImageSequence::isFramePinned(int index)
 {
-	setFrameAtPercent(percent);
-	return &getTexture();
+	ofScopedLock lock(frameMutex);
+	return pinnedFrames.count(index) > 0;
 }
 
-//deprecated
-ofTexture* ofxImageSequence::getFrameForTime(float time)
+//applies to the next pins, frames already pinned stay
+void ofxImageSequence::setPinnedBudget(uint64_t bytes)
 {
-	setFrameForTime(time);
-	return &getTexture();
+	ofScopedLock lock(frameMutex);
+	pinnedBudget = bytes;
 }
 
-//deprecated
-ofTexture* ofxImageSequence::getFrame(int index)
+uint64_t ofxImageSequence::getPinnedBytes()
 {
-	setFrame(index);
-	return &getTexture();
+	ofScopedLock lock(frameMutex);
+	return pinnedBytes;
 }
 
-ofTexture& ofxImageSequence::getTextureForFrame(int index)
+//decodes one pinned frame that isn't yet, returns false when they all are
+bool ofxImageSequence::updatePinnedFrames()
+{
+	int frame = -1;
+	int level = 0;
+	frameMutex.lock();
+	for(map<int, PinnedFrame>::iterator pin = pinnedFrames.begin(); pin != pinnedFrames.end(); ++pin){
+		if(!pin->second.pixels && !isFrameFailed(pin->first)){
+			frame = pin->first;
+			level = pin->second.level;
+			break;
+		}
+	}
+	frameMutex.unlock();
+
+	if(frame == -1){
+		return false;
+	}
+
+	shared_ptr<const ofPixels> pixels = decodePixels(frame, level);
+	if(!pixels){
+		frameStates[frame] &= ~FRAME_PIN_PENDING;
+		markFrameFailed(frame);
+		return true;
+	}
+
+	shared_ptr<ofxImageSequenceLinearFrame> linear = convertLinear(*pixels);
+	uint64_t bytes = pixels->size() + (linear ? linear->getBytes() : 0);
+
+	frameMutex.lock();
+	map<int, PinnedFrame>::iterator pin = pinnedFrames.find(frame);
+	if(pin != pinnedFrames.end() && !pin->second.pixels){
+		pinnedBytes = pinnedBytes - MIN(pin->second.bytes, pinnedBytes) + bytes;
+		pin->second.bytes = bytes;
+		pin->second.pixels = pixels;
+		pin->second.linear = linear;
+		frameStates[frame] &= ~FRAME_PIN_PENDING;
+		frameStates[frame] |= FRAME_PINNED;
+	}
+	frameMutex.unlock();
+	return true;
+}
+
+//reduced frames keep the full size as their draw size so they are stretched back over the same area
+void ofxImageSequence::uploadPixels(ofTexture& target, const ofPixels& pixels, shared_ptr<ofxImageSequenceLinearFrame> linear)
+{
+	if(colorOutput != OFX_IMAGE_SEQUENCE_COLOR_SRGB && (!linear || linear->output != colorOutput)){
+		//only frames that were never kept in RAM, or decoded before the output changed
+		linear = convertLinear(pixels);
+	}
+
+	if(colorOutput == OFX_IMAGE_SEQUENCE_COLOR_LINEAR_16){
+		target.loadData(linear->shortPixels);
+	}
+	else if(colorOutput == OFX_IMAGE_SEQUENCE_COLOR_LINEAR_HALF){
+		//float pixels would allocate 32 bit textures by default
+		int channels = pixels.getNumChannels();
+		int format = channels == 4 ? GL_RGBA16F : GL_RGB16F;
+		if(channels >= 3 && (target.texData.glInternalFormat != format ||
+		   target.getWidth() != pixels.getWidth() || target.getHeight() != pixels.getHeight())){
+			target.allocate(pixels.getWidth(), pixels.getHeight(), format);
+			if(minFilter != 0){
+				target.setTextureMinMagFilter(minFilter, magFilter);
+			}
+		}
+		target.loadData(linear->floatPixels);
+	}
+	else{
+		target.loadData(pixels);
+	}
+	if(width > 0 && pixels.getWidth() < width){
+		target.texData.width = width;
+		target.texData.height = height;
+	}
+}
+
+void ofxImageSequence::prepareSequence(string folder, int framesToPrime)
+{
+	cancelPrepare();
+
+	prepared = new ofxImageSequence();
+	prepared->extension = extension;
+	prepared->maxFrames = maxFrames;
+	prepared->frameRate = frameRate;
+	prepared->targetWidth = targetWidth;
+	prepared->targetHeight = targetHeight;
+	prepared->targetFilter = targetFilter;
+	prepared->colorLut = colorLut;
+	prepared->colorOutput = colorOutput;
+	prepared->frameProcessor = frameProcessor;
+	prepared->sharedCache = sharedCache;
+	prepared->outputFrameRate = outputFrameRate;
+	prepared->playbackSpeed = playbackSpeed;
+	prepared->frameStride = (float)frameStride;
+	prepared->useTexture = useTexture;
+	prepared->diskCacheFolder = diskCacheFolder;
+	prepared->maxUploadsPerFrame = maxUploadsPerFrame;
+	prepared->adaptiveQuality = adaptiveQuality;
+	prepared->maxQualityLevel = maxQualityLevel;
+	prepared->pinnedBudget = pinnedBudget;
+	for(int i = 0; i < OFX_IMAGE_SEQUENCE_NUM_TIERS; i++){
+		prepared->tierBudgets[i] = tierBudgets[i];
+	}
+	if(minFilter != 0){
+		prepared->setMinMagFilter(minFilter, magFilter);
+	}
+	prepared->folderToLoad = folder;
+
+	preparer = new ofxImageSequencePreparer(prepared, MAX(framesToPrime, 1));
+	ofAddListener(ofEvents().update, this, &ofxImageSequence::updatePrepared);
+}
+
+bool ofxImageSequence::isPrepared()
+{
+	if(prepared == NULL || !prepared->loaded){
+		return false;
+	}
+	ofScopedLock lock(prepared->frameMutex);
+	bool bounded = prepared->isTierBounded(OFX_IMAGE_SEQUENCE_TIER_GPU);
+	int primed = MIN(preparer->framesToPrime, (int)prepared->filenames.size());
+	return !bounded || prepared->tierFrameCounts[OFX_IMAGE_SEQUENCE_TIER_GPU] >= MIN(primed, prepared->getTierCapacity(OFX_IMAGE_SEQUENCE_TIER_GPU));
+}
+
+void ofxImageSequence::swapToPrepared()
+{
+	if(prepared == NULL){
+		ofLogError("ofxImageSequence::swapToPrepared") << "Nothing prepared, call prepareSequence first";
+		return;
+	}
+	swapPending = true;
+}
+
+bool ofxImageSequence::isSwapPending()
+{
+	return swapPending;
+}
+
+void ofxImageSequence::cancelPrepare()
+{
+	if(preparer == NULL){
+		return;
+	}
+	ofRemoveListener(ofEvents().update, this, &ofxImageSequence::updatePrepared);
+	delete preparer;
+	delete prepared;
+	preparer = NULL;
+	prepared = NULL;
+	swapPending = false;
+}
+
+//finishes preparing on the main thread, since that uploads, and swaps when asked to
+void ofxImageSequence::updatePrepared(ofEventArgs& args)
+{
+	if(preparer == NULL || !preparer->done){
+		return;
+	}
+
+	if(preparer->failed){
+		ofLogError("ofxImageSequence::prepareSequence") << "Could not prepare " << prepared->folderToLoad;
+		cancelPrepare();
+		return;
+	}
+
+	if(!prepared->loaded){
+		prepared->completeLoading();
+	}
+	prepared->updateResidentTextures();
+
+	if(!swapPending || !isPrepared() || !swapContents(*prepared)){
+		return;
+	}
+
+	if(!prepared->pinnedFrames.empty()){
+		ofLogNotice("ofxImageSequence::swapToPrepared") << "Released " << prepared->pinnedFrames.size()
+			<< " pinned frames of the previous sequence, pin the new frames again if needed";
+	}
+
+	//the old sequence goes on the main thread, with its textures, listeners and tier manager, only its
+	//frames are freed in the background
+	ofRemoveListener(ofEvents().update, this, &ofxImageSequence::updatePrepared);
+	ofxImageSequenceReleasedFrames* frames = new ofxImageSequenceReleasedFrames();
+	if(prepared->tierManager != NULL){
+		delete prepared->tierManager;	//it must not touch the frames once they are gone
+		prepared->tierManager = NULL;
+	}
+	prepared->frameMutex.lock();
+	frames->pixels.swap(prepared->sequence);
+	frames->linearFrames.swap(prepared->linearFrames);
+	frames->compressed.swap(prepared->compressed);
+	for(map<int, PinnedFrame>::iterator pin = prepared->pinnedFrames.begin(); pin != prepared->pinnedFrames.end(); ++pin){
+		frames->pixels.push_back(pin->second.pixels);
+		frames->linearFrames.push_back(pin->second.linear);
+	}
+	prepared->pinnedFrames.clear();
+	prepared->frameMutex.unlock();
+	delete prepared;
+
+	if(releaser.joinable()){
+		releaser.join();
+	}
+	releaser = std::thread([frames]{ delete frames; });
+
+	delete preparer;
+	preparer = NULL;
+	prepared = NULL;
+	swapPending = false;
+
+	startTierManager();
+}
+
+//exchanges the loaded frames with another sequence, fails without waiting if either tier manager is busy
+bool ofxImageSequence::swapContents(ofxImageSequence& other)
+{
+	std::unique_lock<std::mutex> work, otherWork;
+	if(tierManager != NULL){
+		work = std::unique_lock<std::mutex>(tierManager->workMutex, std::try_to_lock);
+		if(!work.owns_lock()) return false;
+	}
+	if(other.tierManager != NULL){
+		otherWork = std::unique_lock<std::mutex>(other.tierManager->workMutex, std::try_to_lock);
+		if(!otherWork.owns_lock()) return false;
+	}
+
+	std::lock(frameMutex, other.frameMutex);
+	std::swap(sequence, other.sequence);
+	std::swap(linearFrames, other.linearFrames);
+	std::swap(filenames, other.filenames);
+	std::swap(compressed, other.compressed);
+	std::swap(frameStates, other.frameStates);
+	std::swap(residentTextures, other.residentTextures);
+	std::swap(texture, other.texture);
+	for(int i = 0; i < OFX_IMAGE_SEQUENCE_NUM_TIERS; i++){
+		std::swap(tierBytes[i], other.tierBytes[i]);
+		std::swap(tierFrameCounts[i], other.tierFrameCounts[i]);
+	}
+	decodedFrameBytes = other.decodedFrameBytes.exchange(decodedFrameBytes);
+	std::swap(frameSizeEstimated, other.frameSizeEstimated);
+	std::swap(folderToLoad, other.folderToLoad);
+	std::swap(loaded, other.loaded);
+	std::swap(curLoadFrame, other.curLoadFrame);
+	std::swap(width, other.width);
+	std::swap(height, other.height);
+	std::swap(lastFrameLoaded, other.lastFrameLoaded);
+	std::swap(currentFrame, other.currentFrame);
+	std::swap(tierPlayhead, other.tierPlayhead);
+	std::swap(playDirection, other.playDirection);
+	std::swap(prefetchQueue, other.prefetchQueue);
+	std::swap(demoteQueue, other.demoteQueue);
+	std::swap(pinnedFrames, other.pinnedFrames);
+	std::swap(pinnedBytes, other.pinnedBytes);
+	resetEvictionPolicy();
+	other.resetEvictionPolicy();
+	frameMutex.unlock();
+	other.frameMutex.unlock();
+	return true;
+}
+
+void ofxImageSequence::enableAdaptiveQuality(bool enable, int maxLevel)
+{
+	adaptiveQuality = enable;
+	maxQualityLevel = MIN(MAX(maxLevel, 0), 3);
+	averageLoadMicros = 0;
+	framesSinceQualityChange = 0;
+	if(!enable && qualityLevel != 0){
+		qualityLevel = 0;
+		int level = 0;
+		ofNotifyEvent(qualityLevelChanged, level, this);
+	}
+}
+
+int ofxImageSequence::getQualityLevel()
+{
+	return qualityLevel;
+}
+
+//degrades quickly when loads eat most of the frame interval, recovers slowly once there is room for a
+//four times more expensive load, so the level doesn't flap around the threshold
+void ofxImageSequence::updateQualityLevel(uint64_t loadMicros)
+{
+	if(!adaptiveQuality || frameRate <= 0){
+		return;
+	}
+
+	float interval = 1000000.0f / frameRate;
+	averageLoadMicros = averageLoadMicros * 0.9f + loadMicros * 0.1f;
+	framesSinceQualityChange++;
+
+	int level = qualityLevel;
+	if(averageLoadMicros > interval * 0.8f && level < maxQualityLevel && framesSinceQualityChange >= 15){
+		level++;
+	}
+	else if(averageLoadMicros < interval * 0.25f && level > 0 && framesSinceQualityChange >= 60){
+		level--;
+	}
+
+	if(level != qualityLevel){
+		ofLogNotice("ofxImageSequence::updateQualityLevel") << "Average load " << averageLoadMicros/1000.0f
+			<< "ms for a " << interval/1000.0f << "ms frame interval, switching to quality level " << level;
+		qualityLevel = level;
+		framesSinceQualityChange = 0;
+		ofNotifyEvent(qualityLevelChanged, level, this);
+	}
+}
+
+bool ofxImageSequence::decodeFrame(int index, ofPixels& pixels, int level)
+{
+	if(!decodeFrame(index, pixels)){
+		return false;
+	}
+	for(int i = 0; i < level && pixels.getWidth() >= 2 && pixels.getHeight() >= 2; i++){
+		ofPixels reduced;
+		ofxImageSequenceHalve(pixels, reduced);
+		pixels.swap(reduced);
+	}
+	return true;
+}
+
+bool ofxImageSequence::decodeFrame(int index, ofPixels& pixels)
+{
+	frameMutex.lock();
+	shared_ptr<ofBuffer> buffer = compressed[index];
+	bool onDisk = (frameStates[index] & (1 << OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE)) != 0;
+	frameMutex.unlock();
+
+	bool decoded = buffer && ofLoadImage(pixels, *buffer);
+	//the disk cache already holds frames resampled, graded and processed
+	if(!decoded && onDisk && readDiskCache(index, pixels)){
+		return true;
+	}
+	if(!decoded && !ofLoadImage(pixels, filenames[index])){
+		return false;
+	}
+	resampleToTarget(pixels);
+	colorLut.apply(pixels);
+	if(frameProcessor){
+		frameProcessor(pixels, index);
+	}
+	return true;
+}
+
+//only full resolution frames are shared, reduced ones stay private
+shared_ptr<const ofPixels> ofxImageSequence::decodePixels(int index, int level)
+{
+	frameStates[index] |= FRAME_DECODING;
+	uint64_t startMicros = ofGetElapsedTimeMicros();
+
+	shared_ptr<const ofPixels> pixels;
+	uint64_t key = sharedCache != NULL && level == 0 ? getSharedFrameKey(index) : 0;
+	if(key != 0){
+		pixels = sharedCache->get(key, [this, index](ofPixels& pixels){ return decodeFrame(index, pixels); });
+	}
+	else{
+		shared_ptr<ofPixels> decoded(new ofPixels());
+		if(decodeFrame(index, *decoded, level)){
+			pixels = decoded;
+		}
+	}
+
+	decodeMicros += ofGetElapsedTimeMicros() - startMicros;
+	numDecodes++;
+	frameStates[index] &= ~FRAME_DECODING;
+	return pixels;
+}
+
+//the source file plus the settings that change the decoded pixels, 0 to decode privately.
+//a frame processor can't be told apart from another one, so its frames are never shared
+uint64_t ofxImageSequence::getSharedFrameKey(int index)
+{
+	if(frameProcessor){
+		return 0;
+	}
+	uint64_t key = ofxImageSequenceSharedCache::getFileKey(filenames[index]);
+	if(key == 0){
+		return 0;
+	}
+	uint64_t settings[4] = { (uint64_t)targetWidth, (uint64_t)targetHeight, (uint64_t)targetFilter, (uint64_t)colorLut.getHash() };
+	for(int i = 0; i < 4; i++){
+		key = (key ^ settings[i]) * 1099511628211ull;
+	}
+	return key;
+}
+
+void ofxImageSequence::resampleToTarget(ofPixels& pixels)
+{
+	if(targetWidth == 0 && targetHeight == 0){
+		return;
+	}
+
+	int w = targetWidth;
+	int h = targetHeight;
+	if(w == 0){
+		w = MAX((int)roundf(pixels.getWidth() * h / (float)pixels.getHeight()), 1);
+	}
+	if(h == 0){
+		h = MAX((int)roundf(pixels.getHeight() * w / (float)pixels.getWidth()), 1);
+	}
+	if(w >= pixels.getWidth() && h >= pixels.getHeight()){
+		return;
+	}
+
+	ofPixels resampled;
+	ofxImageSequenceResample(pixels, resampled, MIN(w, (int)pixels.getWidth()), MIN(h, (int)pixels.getHeight()), targetFilter);
+	pixels.swap(resampled);
+}
+
+shared_ptr<ofxImageSequenceLinearFrame> ofxImageSequence::convertLinear(const ofPixels& pixels)
+{
+	if(colorOutput == OFX_IMAGE_SEQUENCE_COLOR_SRGB){
+		return shared_ptr<ofxImageSequenceLinearFrame>();
+	}
+	return shared_ptr<ofxImageSequenceLinearFrame>(new ofxImageSequenceLinearFrame(pixels, colorOutput));
+}
+
+//called with frameMutex locked. the frame and its linear copy
+uint64_t ofxImageSequence::getDecodedBytes(int index)
+{
+	uint64_t bytes = sequence[index] ? sequence[index]->size() : 0;
+	return linearFrames[index] ? bytes + linearFrames[index]->getBytes() : bytes;
+}
+
+//stored pixels are never modified again, so references handed out by getPixelsForFrame stay valid after demotion.
+//the linear copy is converted here, on the decoding thread, before the frame becomes visible
+shared_ptr<ofxImageSequenceLinearFrame> ofxImageSequence::storeDecodedFrame(int index, shared_ptr<const ofPixels> pixels, int level)
+{
+	shared_ptr<ofxImageSequenceLinearFrame> linear = convertLinear(*pixels);
+
+	frameMutex.lock();
+	//the full size is scaled up from a reduced frame until a full resolution one is decoded
+	if(level == 0 && (decodedFrameBytes == 0 || frameSizeEstimated)){
+		decodedFrameBytes = pixels->size();
+		width  = pixels->getWidth();
+		height = pixels->getHeight();
+		frameSizeEstimated = false;
+	}
+	else if(decodedFrameBytes == 0){
+		decodedFrameBytes = (uint64_t)pixels->size() << (2 * level);
+		width  = pixels->getWidth() << level;
+		height = pixels->getHeight() << level;
+		frameSizeEstimated = true;
+	}
+	if(sequence[index] && getFrameLevel(index) > level){
+		//replace a reduced frame with a sharper one
+		tierBytes[OFX_IMAGE_SEQUENCE_TIER_DECODED] -= getDecodedBytes(index);
+		tierFrameCounts[OFX_IMAGE_SEQUENCE_TIER_DECODED]--;
+		sequence[index].reset();
+		linearFrames[index].reset();
+		if(evictionPolicy){
+			evictionPolicy->removed(index);
+		}
+	}
+	if(!sequence[index] && tierBudgets[OFX_IMAGE_SEQUENCE_TIER_DECODED] != 0){
+		sequence[index] = pixels;
+		linearFrames[index] = linear;
+		tierBytes[OFX_IMAGE_SEQUENCE_TIER_DECODED] += getDecodedBytes(index);
+		tierFrameCounts[OFX_IMAGE_SEQUENCE_TIER_DECODED]++;
+		frameStates[index] |= 1 << OFX_IMAGE_SEQUENCE_TIER_DECODED;
+		setFrameLevel(index, level);
+		if(evictionPolicy){
+			evictionPolicy->inserted(index);
+		}
+	}
+	frameMutex.unlock();
+	return linear;
+}
+
+shared_ptr<const ofPixels> ofxImageSequence::getPixelsForFrame(int index)
+{
+	if(index < 0 || index >= filenames.size()){
+		ofLogError("ofxImageSequence::getPixelsForFrame") << "Calling a frame out of bounds: " << index;
+		return shared_ptr<const ofPixels>();
+	}
+	return acquirePixels(index, true);
+}
+
+shared_ptr<const ofPixels> ofxImageSequence::acquirePixels(int index, bool store)
+{
+	frameMutex.lock();
+	shared_ptr<const ofPixels> pixels = sequence[index];
+	if(pixels && getFrameLevel(index) != 0){
+		pixels.reset(); //analysis always gets full resolution
+	}
+	if(pixels && evictionPolicy){
+		evictionPolicy->accessed(index);
+	}
+	map<int, PinnedFrame>::iterator pin = pinnedFrames.find(index);
+	if(!pixels && pin != pinnedFrames.end() && pin->second.level == 0){
+		pixels = pin->second.pixels;
+	}
+	bool failed = isFrameFailed(index);
+	frameMutex.unlock();
+
+	if(!pixels && !failed){
+		pixels = decodePixels(index, 0);
+		if(!pixels){
+			markFrameFailed(index);
+			return shared_ptr<const ofPixels>();
+		}
+		if(store){
+			storeDecodedFrame(index, pixels, 0);
+		}
+	}
+	return pixels;
+}
+
+void ofxImageSequence::forEachFrame(function<void(int, const ofPixels&)> fn, int numThreads, bool ordered)
+{
+	if(filenames.empty()){
+		ofLogError("ofxImageSequence::forEachFrame") << "Calling forEachFrame on unitialized image sequence.";
+		return;
+	}
+
+	if(numThreads <= 0){
+		numThreads = MAX((int)std::thread::hardware_concurrency(), 1);
+	}
+
+	ofxImageSequenceFrameJob job(this, fn, ordered);
+	vector< shared_ptr<ofxImageSequenceFrameWorker> > workers;
+	for(int i = 0; i < MIN(numThreads, getTotalFrames()); i++){
+		workers.push_back(shared_ptr<ofxImageSequenceFrameWorker>(new ofxImageSequenceFrameWorker(job)));
+	}
+	for(int i = 0; i < workers.size(); i++){
+		workers[i]->waitForThread(false);
+	}
+}
+
+void ofxImageSequence::setUseTexture(bool bUseTex)
+{
+	if(loaded){
+		ofLogError("ofxImageSequence::setUseTexture") << "Need to set texture usage before calling load";
+		return;
+	}
+	useTexture = bUseTex;
+}
+
+bool ofxImageSequence::isUsingTexture() const
+{
+	return useTexture;
+}
+
+void ofxImageSequence::markFrameFailed(int index)
+{
+	frameMutex.lock();
+	frameStates[index] |= FRAME_FAILED;
+	frameMutex.unlock();
+	ofLogError("ofxImageSequence::loadFrame") << "Image failed to load: " << filenames[index];
+}
+
+void ofxImageSequence::setTierBudget(ofxImageSequenceTier tier, uint64_t bytes)
+{
+	if(tier <= OFX_IMAGE_SEQUENCE_TIER_SOURCE || tier >= OFX_IMAGE_SEQUENCE_NUM_TIERS){
+		ofLogError("ofxImageSequence::setTierBudget") << "The source tier has no budget";
+		return;
+	}
+
+	frameMutex.lock();
+	tierBudgets[tier] = bytes;
+	frameMutex.unlock();
+
+	if(loaded){
+		startTierManager();
+		updateResidentTextures();
+	}
+}
+
+uint64_t ofxImageSequence::getTierBudget(ofxImageSequenceTier tier)
+{
+	return tierBudgets[tier];
+}
+
+uint64_t ofxImageSequence::getTierBytes(ofxImageSequenceTier tier)
+{
+	ofScopedLock lock(frameMutex);
+	return tierBytes[tier];
+}
+
+ofxImageSequenceTier ofxImageSequence::getFrameTier(int index)
+{
+	for(int tier = OFX_IMAGE_SEQUENCE_TIER_GPU; tier > OFX_IMAGE_SEQUENCE_TIER_SOURCE; tier--){
+		if(isFrameInTier(index, (ofxImageSequenceTier)tier)){
+			return (ofxImageSequenceTier)tier;
+		}
+	}
+	return OFX_IMAGE_SEQUENCE_TIER_SOURCE;
+}
+
+bool ofxImageSequence::isFrameInTier(int index, ofxImageSequenceTier tier)
+{
+	if(index < 0 || index >= frameStates.size()){
+		return false;
+	}
+	if(tier == OFX_IMAGE_SEQUENCE_TIER_SOURCE){
+		return true;
+	}
+	ofScopedLock lock(frameMutex);
+	return (frameStates[index] & (1 << tier)) != 0;
+}
+
+//failed frames are ready since there is nothing to wait for, and so is everything when frames are never kept decoded
+bool ofxImageSequence::isFrameReady(int index)
+{
+	if(index < 0 || index >= frameStates.size()){
+		return false;
+	}
+	if(index == lastFrameLoaded){
+		return true;
+	}
+	ofScopedLock lock(frameMutex);
+	map<int, PinnedFrame>::iterator pin = pinnedFrames.find(index);
+	return isFrameFailed(index) || tierBudgets[OFX_IMAGE_SEQUENCE_TIER_DECODED] == 0 ||
+		   (frameStates[index] & (1 << OFX_IMAGE_SEQUENCE_TIER_DECODED | 1 << OFX_IMAGE_SEQUENCE_TIER_GPU)) != 0 ||
+		   (pin != pinnedFrames.end() && pin->second.pixels);
+}
+
+//in progress states first, then the hottest place holding the frame
+ofxImageSequenceFrameStatus ofxImageSequence::getFrameStatus(int index)
+{
+	if(!loaded || index < 0 || index >= frameStates.size()){
+		return OFX_IMAGE_SEQUENCE_FRAME_NOT_LOADED;
+	}
+	unsigned short state = frameStates[index];
+	if((state & FRAME_FAILED) != 0){
+		return OFX_IMAGE_SEQUENCE_FRAME_FAILED;
+	}
+	if((state & FRAME_DECODING) != 0){
+		return OFX_IMAGE_SEQUENCE_FRAME_DECODING;
+	}
+	if((state & (1 << OFX_IMAGE_SEQUENCE_TIER_GPU)) != 0){
+		return OFX_IMAGE_SEQUENCE_FRAME_GPU;
+	}
+	if((state & (1 << OFX_IMAGE_SEQUENCE_TIER_DECODED | FRAME_PINNED)) != 0){
+		return OFX_IMAGE_SEQUENCE_FRAME_DECODED;
+	}
+	if((state & (FRAME_QUEUED | FRAME_PIN_PENDING)) != 0){
+		return OFX_IMAGE_SEQUENCE_FRAME_QUEUED;
+	}
+	if((state & (1 << OFX_IMAGE_SEQUENCE_TIER_COMPRESSED)) != 0){
+		return OFX_IMAGE_SEQUENCE_FRAME_COMPRESSED;
+	}
+	return OFX_IMAGE_SEQUENCE_FRAME_NOT_LOADED;
+}
+
+//the playhead and budgets only change on the main thread, so this needs no lock there either
+bool ofxImageSequence::isFrameInPrefetchWindow(int index)
+{
+	if(!loaded){
+		return false;
+	}
+	uint64_t frameBytes = getTierFrameBytes(OFX_IMAGE_SEQUENCE_TIER_DECODED);
+	if(index < 0 || index >= sequence.size() || frameBytes == 0 || !isTierBounded(OFX_IMAGE_SEQUENCE_TIER_DECODED)){
+		return false;
+	}
+	int capacity = MIN(tierBudgets[OFX_IMAGE_SEQUENCE_TIER_DECODED] / frameBytes, (uint64_t)sequence.size());
+	return isFrameNearPlayhead(index, tierPlayhead, playDirection, capacity);
+}
+
+ofxImageSequenceStats ofxImageSequence::getStats()
+{
+	ofxImageSequenceStats stats;
+	stats.hits = numHits;
+	stats.misses = numMisses;
+	stats.decodes = numDecodes;
+	stats.decodeMicros = decodeMicros;
+	stats.decodedBytes = 0;
+	for(int i = 0; i < OFX_IMAGE_SEQUENCE_NUM_FRAME_STATUS; i++){
+		stats.frameCounts[i] = 0;
+	}
+	stats.gpuBytes = 0;
+	if(!loaded){
+		return stats;
+	}
+
+	//every entry and counter is atomic, so the scan never blocks the loaders or the tier manager
+	uint64_t frameBytes = getTierFrameBytes(OFX_IMAGE_SEQUENCE_TIER_DECODED);
+	int gpuFrames = 0;
+	for(int i = 0; i < frameStates.size(); i++){
+		unsigned short state = frameStates[i];
+		if((state & (1 << OFX_IMAGE_SEQUENCE_TIER_DECODED)) != 0){
+			stats.decodedBytes += frameBytes >> (2 * ((state & FRAME_LEVEL_MASK) >> FRAME_LEVEL_SHIFT));
+		}
+		if((state & (1 << OFX_IMAGE_SEQUENCE_TIER_GPU)) != 0){
+			gpuFrames++;
+		}
+		stats.frameCounts[getFrameStatus(i)]++;
+	}
+	stats.gpuBytes = gpuFrames * getTierFrameBytes(OFX_IMAGE_SEQUENCE_TIER_GPU);
+	return stats;
+}
+
+void ofxImageSequence::resetStats()
+{
+	numHits = 0;
+	numMisses = 0;
+	numDecodes = 0;
+	decodeMicros = 0;
+}
+
+void ofxImageSequence::setEvictionPolicy(ofxImageSequenceEviction eviction)
+{
+	setEvictionPolicy(ofxImageSequenceCreateEvictionPolicy(eviction));
+}
+
+//frames already decoded are handed to the new policy, in frame order since their history is unknown
+void ofxImageSequence::setEvictionPolicy(shared_ptr<ofxImageSequenceEvictionPolicy> policy)
+{
+	frameMutex.lock();
+	evictionPolicy = policy;
+	resetEvictionPolicy();
+	frameMutex.unlock();
+
+	if(loaded){
+		startTierManager();
+	}
+}
+
+//called with frameMutex locked
+void ofxImageSequence::resetEvictionPolicy()
+{
+	if(!evictionPolicy){
+		return;
+	}
+	evictionPolicy->reset();
+	for(int i = 0; i < frameStates.size(); i++){
+		if((frameStates[i] & (1 << OFX_IMAGE_SEQUENCE_TIER_DECODED)) != 0 && (frameStates[i] & FRAME_HELD) == 0){
+			evictionPolicy->inserted(i);
+		}
+	}
+}
+
+//called with frameMutex locked
+ofxImageSequenceEvictionContext ofxImageSequence::getEvictionContext()
+{
+	ofxImageSequenceEvictionContext context;
+	context.playhead = tierPlayhead;
+	context.direction = playDirection;
+	context.numFrames = sequence.size();
+	return context;
+}
+
+void ofxImageSequence::setSharedCache(ofxImageSequenceSharedCache* cache)
+{
+	sharedCache = cache;
+}
+
+void ofxImageSequence::setTrace(ofxImageSequenceTrace* _trace, int sequenceId)
+{
+	trace = _trace;
+	traceId = sequenceId;
+}
+
+void ofxImageSequence::setDiskCacheFolder(string folder)
+{
+	if(loaded){
+		ofLogError("ofxImageSequence::setDiskCacheFolder") << "Disk cache folder must be set before load";
+		return;
+	}
+	if(!ofDirectory::doesDirectoryExist(folder)){
+		ofDirectory::createDirectory(folder, true, true);
+	}
+	diskCacheFolder = folder;
+}
+
+void ofxImageSequence::setMaxUploadsPerFrame(int maxUploads)
+{
+	maxUploadsPerFrame = MAX(maxUploads, 0);
+}
+
+void ofxImageSequence::startTierManager()
+{
+	frameMutex.lock();
+	bool needed = false;
+	for(int tier = OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE; tier <= OFX_IMAGE_SEQUENCE_TIER_DECODED; tier++){
+		//also needed to drain a tier whose budget was lowered
+		if(isTierBounded((ofxImageSequenceTier)tier) ||
+		   (tierBudgets[tier] != OFX_IMAGE_SEQUENCE_UNLIMITED && tierFrameCounts[tier] > 0)){
+			needed = true;
+		}
+	}
+	frameMutex.unlock();
+
+	if(tierManager != NULL){
+		tierManager->notify();
+	}
+	else if(needed){
+		tierManager = new ofxImageSequenceTierManager(this);
+	}
+}
+
+//called with frameMutex locked
+bool ofxImageSequence::isTierBounded(ofxImageSequenceTier tier)
+{
+	if(tier == OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE && diskCacheFolder.empty()){
+		return false;
+	}
+	if(tier == OFX_IMAGE_SEQUENCE_TIER_GPU && !useTexture){
+		return false;
+	}
+	return tierBudgets[tier] > 0 && tierBudgets[tier] != OFX_IMAGE_SEQUENCE_UNLIMITED;
+}
+
+//called with frameMutex locked
+bool ofxImageSequence::hasTierRoom(ofxImageSequenceTier tier, uint64_t bytes)
+{
+	if(tierBudgets[tier] == OFX_IMAGE_SEQUENCE_UNLIMITED){
+		return true;
+	}
+	return tierBytes[tier] + bytes <= tierBudgets[tier];
+}
+
+//called with frameMutex locked
+uint64_t ofxImageSequence::getTierFrameBytes(ofxImageSequenceTier tier)
+{
+	if(tier == OFX_IMAGE_SEQUENCE_TIER_GPU && colorOutput != OFX_IMAGE_SEQUENCE_COLOR_SRGB){
+		return decodedFrameBytes * 2;	//16 bit channels
+	}
+	if(tier == OFX_IMAGE_SEQUENCE_TIER_DECODED && colorOutput != OFX_IMAGE_SEQUENCE_COLOR_SRGB){
+		//plus the linear copy, 16 bit or float channels
+		return decodedFrameBytes * (colorOutput == OFX_IMAGE_SEQUENCE_COLOR_LINEAR_16 ? 3 : 5);
+	}
+	if(tier != OFX_IMAGE_SEQUENCE_TIER_COMPRESSED){
+		return decodedFrameBytes;
+	}
+	if(tierFrameCounts[tier] > 0){
+		return tierBytes[tier] / tierFrameCounts[tier];
+	}
+	return filenames.empty() ? 0 : ofFile(filenames[0]).getSize();
+}
+
+//called with frameMutex locked
+int ofxImageSequence::getTierCapacity(ofxImageSequenceTier tier)
+{
+	uint64_t frameBytes = getTierFrameBytes(tier);
+	if(frameBytes == 0){
+		return 0;
+	}
+	return MIN(tierBudgets[tier] / frameBytes, (uint64_t)sequence.size());
+}
+
+//windows keep three frames ahead of the playhead for every frame behind it
+static void splitWindow(int count, int total, int& ahead, int& behind)
+{
+	count = MIN(count, total);
+	behind = count / 4;
+	ahead = count - behind;
+}
+
+void ofxImageSequence::getFramesNearPlayhead(int playhead, int direction, int count, vector<int>& frames)
+{
+	frames.clear();
+	int total = sequence.size();
+	if(total == 0 || count <= 0){
+		return;
+	}
+
+	int ahead, behind;
+	splitWindow(count, MAX((int)(total / frameStride), 1), ahead, behind);
+
+	//nearest first, wrapping around the ends so loops stay warm, only the frames that will be presented
+	int back = 1;
+	for(int i = 0; i < ahead; i++){
+		frames.push_back(((playhead + getStrideOffset(i)*direction) % total + total) % total);
+		if(i % 3 == 2 && back <= behind){
+			frames.push_back(((playhead - getStrideOffset(back)*direction) % total + total) % total);
+			back++;
+		}
+	}
+	for(; back <= behind; back++){
+		frames.push_back(((playhead - getStrideOffset(back)*direction) % total + total) % total);
+	}
+}
+
+bool ofxImageSequence::isFrameNearPlayhead(int index, int playhead, int direction, int count)
+{
+	int total = sequence.size();
+	if(total == 0 || count <= 0){
+		return false;
+	}
+
+	float stride = frameStride;
+	int ahead, behind;
+	splitWindow(count, MAX((int)(total / stride), 1), ahead, behind);
+
+	//frames skipped by the stride are never near, they won't be presented
+	int distance = (((index - playhead) * direction) % total + total) % total;
+	int presentedAhead = (int)roundf(distance / stride);
+	if(presentedAhead < ahead && getStrideOffset(presentedAhead) == distance){
+		return true;
+	}
+	int presentedBehind = (int)roundf((total - distance) / stride);
+	return presentedBehind >= 1 && presentedBehind <= behind && getStrideOffset(presentedBehind) == total - distance;
+}
+
+bool ofxImageSequence::updateTiers()
+{
+	//hottest RAM tier first so the frames needed for playback come before the warm ones
+	static const ofxImageSequenceTier ramTiers[] = {
+		OFX_IMAGE_SEQUENCE_TIER_DECODED,
+		OFX_IMAGE_SEQUENCE_TIER_COMPRESSED,
+		OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE
+	};
+
+	//queued demotions free memory and may write the disk cache, so they run here first
+	int drop = -1;
+	frameMutex.lock();
+	if(!demoteQueue.empty()){
+		drop = demoteQueue.front();
+		demoteQueue.pop_front();
+		if((frameStates[drop] & FRAME_HELD) != 0){
+			drop = -1;	//held again by another cue since it was queued
+		}
+	}
+	frameMutex.unlock();
+	if(drop != -1){
+		demoteFrame(drop, OFX_IMAGE_SEQUENCE_TIER_DECODED);
+		return true;
+	}
+
+	//pinned frames come before anything else, then explicit prefetches
+	if(updatePinnedFrames()){
+		return true;
+	}
+
+	int prefetch = -1;
+	frameMutex.lock();
+	while(!prefetchQueue.empty() && prefetch == -1){
+		int frame = prefetchQueue.front();
+		prefetchQueue.pop_front();
+		frameStates[frame] &= ~FRAME_QUEUED;
+		if(!sequence[frame] && !isFrameFailed(frame) && tierBudgets[OFX_IMAGE_SEQUENCE_TIER_DECODED] != 0 &&
+		   hasTierRoom(OFX_IMAGE_SEQUENCE_TIER_DECODED, getTierFrameBytes(OFX_IMAGE_SEQUENCE_TIER_DECODED))){
+			prefetch = frame;
+		}
+	}
+	frameMutex.unlock();
+
+	if(prefetch != -1){
+		promoteFrame(prefetch, OFX_IMAGE_SEQUENCE_TIER_DECODED);
+		return true;
+	}
+
+	vector<int> window;
+	for(int t = 0; t < 3; t++){
+		ofxImageSequenceTier tier = ramTiers[t];
+		unsigned char bit = 1 << tier;
+
+		frameMutex.lock();
+		bool evicting = tier == OFX_IMAGE_SEQUENCE_TIER_DECODED && evictionPolicy;
+		frameMutex.unlock();
+		if(evicting){
+			if(updateEvictedTier()){
+				return true;
+			}
+			continue;
+		}
+
+		frameMutex.lock();
+		int playhead = tierPlayhead;
+		int direction = playDirection;
+		bool bounded = isTierBounded(tier);
+		bool demotes = bounded || tierBudgets[tier] != OFX_IMAGE_SEQUENCE_UNLIMITED;
+		int capacity = bounded ? getTierCapacity(tier) : 0;
+		uint64_t frameBytes = getTierFrameBytes(tier);
+
+		int demote = -1;
+		if(demotes && tierFrameCounts[tier] > 0 && !(bounded && capacity == 0)){
+			for(int i = 0; i < frameStates.size(); i++){
+				if((frameStates[i] & bit) != 0 && (frameStates[i] & FRAME_HELD) == 0 &&
+				   !isFrameNearPlayhead(i, playhead, direction, capacity)){
+					demote = i;
+					break;
+				}
+			}
+		}
+		frameMutex.unlock();
+
+		if(demote != -1){
+			demoteFrame(demote, tier);
+			return true;
+		}
+		if(!bounded || capacity == 0){
+			continue;
+		}
+
+		getFramesNearPlayhead(playhead, direction, capacity, window);
+
+		int promote = -1;
+		frameMutex.lock();
+		for(int i = 0; i < window.size(); i++){
+			int frame = window[i];
+			if((frameStates[frame] & bit) == 0 && !isFrameFailed(frame)){
+				if(hasTierRoom(tier, frameBytes)){
+					promote = frame;
+				}
+				break;
+			}
+		}
+		frameMutex.unlock();
+
+		if(promote != -1){
+			promoteFrame(promote, tier);
+			return true;
+		}
+	}
+	return false;
+}
+
+//the decoded tier under an eviction policy: the policy's victims go while the tier is over budget, and the
+//playback window is prefetched into free room, or in place of the victim when the policy prefers the window frame
+bool ofxImageSequence::updateEvictedTier()
+{
+	ofxImageSequenceTier tier = OFX_IMAGE_SEQUENCE_TIER_DECODED;
+	unsigned char bit = 1 << tier;
+
+	frameMutex.lock();
+	shared_ptr<ofxImageSequenceEvictionPolicy> policy = evictionPolicy;
+	ofxImageSequenceEvictionContext context = getEvictionContext();
+	int victim = -1;
+	if(policy && tierBudgets[tier] != OFX_IMAGE_SEQUENCE_UNLIMITED && tierBytes[tier] > tierBudgets[tier]){
+		victim = policy->selectVictim(context);
+	}
+	int capacity = policy && isTierBounded(tier) ? getTierCapacity(tier) : 0;
+	frameMutex.unlock();
+
+	if(victim != -1){
+		demoteFrame(victim, tier);
+		return true;
+	}
+	if(capacity == 0){
+		return false;
+	}
+
+	vector<int> window;
+	getFramesNearPlayhead(context.playhead, context.direction, capacity, window);
+
+	int promote = -1;
+	frameMutex.lock();
+	for(int i = 0; i < window.size(); i++){
+		int frame = window[i];
+		if((frameStates[frame] & bit) == 0 && !isFrameFailed(frame)){
+			if(hasTierRoom(tier, getTierFrameBytes(tier))){
+				promote = frame;
+			}
+			else{
+				victim = policy->selectVictim(context);
+				if(victim != -1 && !policy->shouldReplace(frame, victim, context)){
+					victim = -1;
+				}
+			}
+			break;
+		}
+	}
+	frameMutex.unlock();
+
+	if(victim != -1){
+		demoteFrame(victim, tier);
+		return true;
+	}
+	if(promote != -1){
+		promoteFrame(promote, tier);
+		return true;
+	}
+	return false;
+}
+
+void ofxImageSequence::promoteFrame(int index, ofxImageSequenceTier tier)
+{
+	if(tier == OFX_IMAGE_SEQUENCE_TIER_DECODED){
+		int level = qualityLevel;
+		shared_ptr<const ofPixels> pixels = decodePixels(index, level);
+		if(pixels){
+			storeDecodedFrame(index, pixels, level);
+		}
+		else{
+			markFrameFailed(index);
+		}
+	}
+	else if(tier == OFX_IMAGE_SEQUENCE_TIER_COMPRESSED){
+		shared_ptr<ofBuffer> buffer(new ofBuffer(ofBufferFromFile(filenames[index], true)));
+		if(buffer->size() == 0){
+			markFrameFailed(index);
+			return;
+		}
+		frameMutex.lock();
+		if(!compressed[index]){
+			compressed[index] = buffer;
+			tierBytes[tier] += buffer->size();
+			tierFrameCounts[tier]++;
+			frameStates[index] |= 1 << tier;
+		}
+		frameMutex.unlock();
+	}
+	else if(tier == OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE){
+		//the disk cache only holds full resolution frames
+		frameMutex.lock();
+		shared_ptr<const ofPixels> pixels = sequence[index];
+		if(pixels && getFrameLevel(index) != 0){
+			pixels.reset();
+		}
+		frameMutex.unlock();
+
+		if(!pixels){
+			pixels = decodePixels(index, 0);
+			if(!pixels){
+				markFrameFailed(index);
+				return;
+			}
+		}
+
+		if(!writeDiskCache(index, *pixels)){
+			ofLogError("ofxImageSequence::promoteFrame") << "Could not write to disk cache folder " << diskCacheFolder << ", disabling the disk cache tier";
+			frameMutex.lock();
+			tierBudgets[tier] = 0;
+			frameMutex.unlock();
+			return;
+		}
+		frameMutex.lock();
+		tierBytes[tier] += ofFile(getDiskCachePath(index)).getSize();
+		tierFrameCounts[tier]++;
+		frameStates[index] |= 1 << tier;
+		frameMutex.unlock();
+	}
+}
+
+void ofxImageSequence::queueDemotion(int index)
+{
+	frameMutex.lock();
+	demoteQueue.push_back(index);
+	frameMutex.unlock();
+	wakeTierManager();
+}
+
+//held frames are taken out of the eviction policy, so no policy can pick them as victims
+bool ofxImageSequence::holdFrame(int index)
+{
+	ofScopedLock lock(frameMutex);
+	if(index < 0 || index >= sequence.size() || !sequence[index] || getFrameLevel(index) != 0){
+		return false;
+	}
+	if((frameStates[index] & FRAME_HELD) == 0){
+		frameStates[index] |= FRAME_HELD;
+		if(evictionPolicy){
+			evictionPolicy->removed(index);
+		}
+	}
+	return true;
+}
+
+void ofxImageSequence::releaseFrame(int index)
+{
+	ofScopedLock lock(frameMutex);
+	if(index < 0 || index >= sequence.size() || (frameStates[index] & FRAME_HELD) == 0){
+		return;
+	}
+	frameStates[index] &= ~FRAME_HELD;
+	if(evictionPolicy && sequence[index]){
+		evictionPolicy->inserted(index);
+	}
+}
+
+void ofxImageSequence::demoteFrame(int index, ofxImageSequenceTier tier)
+{
+	unsigned char bit = 1 << tier;
+	unsigned char diskBit = 1 << OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE;
+	shared_ptr<const ofPixels> pixels;
+	bool keepOnDisk = false;
+
+	frameMutex.lock();
+	if((frameStates[index] & bit) == 0){
+		frameMutex.unlock();
+		return;
+	}
+	frameStates[index] &= ~bit;
+	tierFrameCounts[tier]--;
+	if(tier == OFX_IMAGE_SEQUENCE_TIER_DECODED){
+		frameStates[index] &= ~FRAME_HELD;
+		tierBytes[tier] -= getDecodedBytes(index);
+		pixels.swap(sequence[index]);
+		linearFrames[index].reset();
+		if(evictionPolicy){
+			evictionPolicy->removed(index);
+		}
+
+		//frames leaving RAM drop to the disk cache when it wants them, saving a decode later
+		keepOnDisk = getFrameLevel(index) == 0 &&
+					 isTierBounded(OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE) &&
+					 (frameStates[index] & diskBit) == 0 &&
+					 isFrameNearPlayhead(index, tierPlayhead, playDirection, getTierCapacity(OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE)) &&
+					 hasTierRoom(OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE, pixels->size());
+	}
+	else if(tier == OFX_IMAGE_SEQUENCE_TIER_COMPRESSED){
+		tierBytes[tier] -= compressed[index]->size();
+		compressed[index].reset();
+	}
+	frameMutex.unlock();
+
+	if(tier == OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE){
+		string path = getDiskCachePath(index);
+		uint64_t size = ofFile(path).getSize();
+		ofFile::removeFile(path);
+		frameMutex.lock();
+		tierBytes[tier] -= MIN(size, tierBytes[tier]);
+		frameMutex.unlock();
+	}
+
+	if(keepOnDisk && writeDiskCache(index, *pixels)){
+		frameMutex.lock();
+		tierBytes[OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE] += ofFile(getDiskCachePath(index)).getSize();
+		tierFrameCounts[OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE]++;
+		frameStates[index] |= diskBit;
+		frameMutex.unlock();
+	}
+}
+
+//runs on the main thread since it touches GL
+void ofxImageSequence::updateResidentTextures()
+{
+	unsigned char bit = 1 << OFX_IMAGE_SEQUENCE_TIER_GPU;
+	ofScopedLock lock(frameMutex);
+
+	bool bounded = isTierBounded(OFX_IMAGE_SEQUENCE_TIER_GPU);
+	if(!bounded && residentTextures.empty()){
+		return;
+	}
+	int capacity = bounded ? getTierCapacity(OFX_IMAGE_SEQUENCE_TIER_GPU) : 0;
+
+	//textures that left the window are released, except the one on screen
+	map<int, ofTexture>::iterator it = residentTextures.begin();
+	while(it != residentTextures.end()){
+		if(it->first != lastFrameLoaded && !isFrameNearPlayhead(it->first, tierPlayhead, playDirection, capacity)){
+			frameStates[it->first] &= ~bit;
+			tierBytes[OFX_IMAGE_SEQUENCE_TIER_GPU] -= MIN(getTierFrameBytes(OFX_IMAGE_SEQUENCE_TIER_GPU), tierBytes[OFX_IMAGE_SEQUENCE_TIER_GPU]);
+			tierFrameCounts[OFX_IMAGE_SEQUENCE_TIER_GPU]--;
+			residentTextures.erase(it++);
+		}
+		else{
+			++it;
+		}
+	}
+
+	vector<int> window;
+	getFramesNearPlayhead(tierPlayhead, playDirection, capacity, window);
+
+	int uploads = 0;
+	for(int i = 0; i < window.size() && uploads < maxUploadsPerFrame; i++){
+		int frame = window[i];
+		if((frameStates[frame] & bit) != 0 || !sequence[frame]){
+			continue;
+		}
+		if(!hasTierRoom(OFX_IMAGE_SEQUENCE_TIER_GPU, getTierFrameBytes(OFX_IMAGE_SEQUENCE_TIER_GPU))){
+			break;
+		}
+		ofTexture& resident = residentTextures[frame];
+		uploadPixels(resident, *sequence[frame], linearFrames[frame]);
+		if(minFilter != 0){
+			resident.setTextureMinMagFilter(minFilter, magFilter);
+		}
+		frameStates[frame] |= bit;
+		tierBytes[OFX_IMAGE_SEQUENCE_TIER_GPU] += getTierFrameBytes(OFX_IMAGE_SEQUENCE_TIER_GPU);
+		tierFrameCounts[OFX_IMAGE_SEQUENCE_TIER_GPU]++;
+		uploads++;
+	}
+}
+
+string ofxImageSequence::getDiskCachePath(int index)
+{
+	//named after the whole source path so sequences can share a folder, and the target size since frames are cached resampled
+	std::hash<string> hashPath;
+	stringstream name;
+	name << hex << hashPath(filenames[index]) << "_" << ofFilePath::getFileName(filenames[index]);
+	if(targetWidth != 0 || targetHeight != 0){
+		name << dec << "_" << targetWidth << "x" << targetHeight << "_" << targetFilter;
+	}
+	if(!colorLut.isEmpty()){
+		name << "_" << hex << colorLut.getHash();
+	}
+	name << ".raw";
+	return ofToDataPath(ofFilePath::join(diskCacheFolder, name.str()));
+}
+
+bool ofxImageSequence::writeDiskCache(int index, const ofPixels& pixels)
+{
+	ofstream file(getDiskCachePath(index).c_str(), ios::binary);
+	int header[3] = { (int)pixels.getWidth(), (int)pixels.getHeight(), (int)pixels.getNumChannels() };
+	file.write((const char*)header, sizeof(header));
+	file.write((const char*)pixels.getData(), pixels.size());
+	return file.good();
+}
+
+bool ofxImageSequence::readDiskCache(int index, ofPixels& pixels)
+{
+	ifstream file(getDiskCachePath(index).c_str(), ios::binary);
+	int header[3];
+	if(!file.read((char*)header, sizeof(header))){
+		return false;
+	}
+	pixels.allocate(header[0], header[1], header[2]);
+	return file.read((char*)pixels.getData(), pixels.size()).good();
+}
+
+float ofxImageSequence::getPercentAtFrameIndex(int index)
+{
+	return ofMap(index, 0, sequence.size()-1, 0, 1.0, true);
+}
+
+float ofxImageSequence::getWidth()
+{
+	return width;
+}
+
+float ofxImageSequence::getHeight()
+{
+	return height;
+}
+
+void ofxImageSequence::unloadSequence()
+{
+	cancelPrepare();
+
+	if(threadLoader != NULL){
+		delete threadLoader;
+		threadLoader = NULL;
+	}
+
+	if(tierManager != NULL){
+		delete tierManager;
+		tierManager = NULL;
+	}
+
+	for(int i = 0; i < frameStates.size(); i++){
+		if((frameStates[i] & (1 << OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE)) != 0){
+			ofFile::removeFile(getDiskCachePath(i));
+		}
+	}
+
+	sequence.clear();
+	linearFrames.clear();
+	filenames.clear();
+	compressed.clear();
+	frameStates.clear();
+	residentTextures.clear();
+
+	for(int i = 0; i < OFX_IMAGE_SEQUENCE_NUM_TIERS; i++){
+		tierBytes[i] = 0;
+		tierFrameCounts[i] = 0;
+	}
+	decodedFrameBytes = 0;
+	frameSizeEstimated = false;
+	tierPlayhead = 0;
+	playDirection = 1;
+	prefetchQueue.clear();
+	demoteQueue.clear();
+	if(evictionPolicy){
+		evictionPolicy->reset();
+	}
+	pinnedFrames.clear();
+	pinnedBytes = 0;
+	resetStats();
+
+	loaded = false;
+	width = 0;
+	height = 0;
+	curLoadFrame = 0;
+	lastFrameLoaded = -1;
+	currentFrame = 0;	
+
+}
+
+void ofxImageSequence::setFrameRate(float rate)
+{
+	frameRate = rate;
+	updateFrameStride();
+}
+
+void ofxImageSequence::setOutputFrameRate(float rate)
+{
+	outputFrameRate = MAX(rate, 0.0f);
+	updateFrameStride();
+}
+
+void ofxImageSequence::setPlaybackSpeed(float speed)
+{
+	playbackSpeed = fabs(speed);
+	updateFrameStride();
+}
+
+float ofxImageSequence::getFrameStride()
+{
+	return frameStride;
+}
+
+void ofxImageSequence::updateFrameStride()
+{
+	float stride = 1.0f;
+	if(outputFrameRate > 0){
+		stride = MAX(frameRate * playbackSpeed / outputFrameRate, 1.0f);
+	}
+	if(stride == frameStride){
+		return;
+	}
+	frameStride = stride;
+
+	//the windows change, let the tier manager re-evaluate them
+	if(tierManager != NULL){
+		tierManager->notify();
+	}
+}
+
+int ofxImageSequence::getStrideOffset(int presentedFrames)
+{
+	return (int)roundf(presentedFrames * frameStride);
+}
+
+string ofxImageSequence::getFilePath(int index){
+	if(index > 0 && index < filenames.size()){
+		return filenames[index];
+	}
+	ofLogError("ofxImageSequence::getFilePath") << "Getting filename outside of range";
+	return "";
+}
+
+int ofxImageSequence::getFrameIndexAtPercent(float percent)
+{
+    if (percent < 0.0 || percent > 1.0) percent -= floor(percent);
+
+	return MIN((int)(percent*sequence.size()), sequence.size()-1);
+}
+
+//deprecated
+ofTexture& ofxImageSequence::getTextureReference()
+{
+	return getTexture();
+}
+
+//deprecated
+ofTexture* ofxImageSequence::getFrameAtPercent(float percent)
+{
+	setFrameAtPercent(percent);
+	return &getTexture();
+}
+
+//deprecated
+ofTexture* ofxImageSequence::getFrameForTime(float time)
+{
+	setFrameForTime(time);
+	return &getTexture();
+}
+
+//deprecated
+ofTexture* ofxImageSequence::getFrame(int index)
+{
+	setFrame(index);
+	return &getTexture();
+}
+
+ofTexture& ofxImageSequence::getTextureForFrame(int index)
 {
 	setFrame(index);
 	return getTexture();
@@ -460,9 +2409,32 @@ void ofxImageSequence::setFrame(int index)
 	}
 	
 	index %= getTotalFrames();
-	
+
+	//track which way the playhead travels, taking the shortest way around for loops
+	int total = getTotalFrames();
+	int delta = index - currentFrame;
+	if(delta > total/2) delta -= total;
+	if(delta < -total/2) delta += total;
+
+	frameMutex.lock();
+	if(delta != 0){
+		playDirection = delta > 0 ? 1 : -1;
+	}
+	tierPlayhead = index;
+	uint64_t frameBytes = decodedFrameBytes;
+	frameMutex.unlock();
+
+	if(trace != NULL){
+		trace->recordRequest(traceId, index, total, frameBytes);
+	}
+
+	if(tierManager != NULL){
+		tierManager->notify();
+	}
+
 	loadFrame(index);
 	currentFrame = index;
+	updateResidentTextures();
 }
 
 void ofxImageSequence::setFrameForTime(float time)
@@ -479,11 +2451,19 @@ void ofxImageSequence::setFrameAtPercent(float percent)
 
 ofTexture& ofxImageSequence::getTexture()
 {
+	map<int, ofTexture>::iterator it = residentTextures.find(lastFrameLoaded);
+	if(it != residentTextures.end()){
+		return it->second;
+	}
 	return texture;
 }
 
 const ofTexture& ofxImageSequence::getTexture() const
 {
+	map<int, ofTexture>::const_iterator it = residentTextures.find(lastFrameLoaded);
+	if(it != residentTextures.end()){
+		return it->second;
+	}
 	return texture;
 }
 
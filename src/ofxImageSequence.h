@@ -47,9 +47,71 @@
 #pragma once
 
 #include "ofMain.h"
+#include "ofxImageSequenceResample.h"
+#include "ofxImageSequenceColor.h"
+#include "ofxImageSequenceFilenames.h"
+#include "ofxImageSequencePattern.h"
+#include "ofxImageSequenceSharedCache.h"
+#include "ofxImageSequenceTrace.h"
+#include "ofxImageSequenceEviction.h"
+
+//storage tiers from cheapest to hottest. frames are promoted toward the GPU as the playhead approaches
+//and demoted as it leaves, each tier keeping as many frames around the playhead as its budget allows
+enum ofxImageSequenceTier {
+	OFX_IMAGE_SEQUENCE_TIER_SOURCE = 0,		//only the filename is known, the frame is read from its source file
+	OFX_IMAGE_SEQUENCE_TIER_DISK_CACHE,		//decoded pixels written raw to the disk cache folder
+	OFX_IMAGE_SEQUENCE_TIER_COMPRESSED,		//encoded file bytes held in RAM
+	OFX_IMAGE_SEQUENCE_TIER_DECODED,		//decoded pixels held in RAM
+	OFX_IMAGE_SEQUENCE_TIER_GPU,			//resident texture on the graphics card
+	OFX_IMAGE_SEQUENCE_NUM_TIERS
+};
+
+//tier budget that never demotes, the default for decoded frames
+const uint64_t OFX_IMAGE_SEQUENCE_UNLIMITED = numeric_limits<uint64_t>::max();
+
+//what a frame is doing right now, for diagnostics
+enum ofxImageSequenceFrameStatus {
+	OFX_IMAGE_SEQUENCE_FRAME_NOT_LOADED = 0,	//only on disk, in its source file or the disk cache
+	OFX_IMAGE_SEQUENCE_FRAME_QUEUED,			//waiting in the prefetch queue or for its pin
+	OFX_IMAGE_SEQUENCE_FRAME_DECODING,
+	OFX_IMAGE_SEQUENCE_FRAME_COMPRESSED,		//encoded file bytes in RAM
+	OFX_IMAGE_SEQUENCE_FRAME_DECODED,			//decoded pixels in RAM, pinned or in the decoded tier
+	OFX_IMAGE_SEQUENCE_FRAME_GPU,
+	OFX_IMAGE_SEQUENCE_FRAME_FAILED,
+	OFX_IMAGE_SEQUENCE_NUM_FRAME_STATUS
+};
+
+struct ofxImageSequenceStats {
+	uint64_t hits;				//setFrame calls shown without waiting for a decode
+	uint64_t misses;			//setFrame calls that decoded on the spot
+	uint64_t decodes;			//on every thread, prefetches included
+	uint64_t decodeMicros;		//total time of those decodes
+	uint64_t decodedBytes;		//estimated size of the decoded tier
+	uint64_t gpuBytes;			//estimated size of the resident textures
+	int frameCounts[OFX_IMAGE_SEQUENCE_NUM_FRAME_STATUS];
+};
+
+//frame table entry. writers hold frameMutex, but readers can skip it since every access is atomic,
+//which lets diagnostics scan the whole table each frame without stalling the loaders
+class ofxImageSequenceFrameState {
+  public:
+	ofxImageSequenceFrameState(unsigned short bits = 0) : bits(bits){}
+	ofxImageSequenceFrameState(const ofxImageSequenceFrameState& other) : bits((unsigned short)other){}
+	ofxImageSequenceFrameState& operator=(const ofxImageSequenceFrameState& other){ bits.store(other, std::memory_order_relaxed); return *this; }
+	operator unsigned short() const { return bits.load(std::memory_order_relaxed); }
+	void operator|=(unsigned short mask){ bits.fetch_or(mask, std::memory_order_relaxed); }
+	void operator&=(unsigned short mask){ bits.fetch_and(mask, std::memory_order_relaxed); }
+
+  protected:
+	std::atomic<unsigned short> bits;
+};
 
 class ofxImageSequenceLoader;
+class ofxImageSequenceTierManager;
+class ofxImageSequencePreparer;
+class ofxImageSequenceScheduler;
 class ofxImageSequence : public ofBaseHasTexture {
+	friend class ofxImageSequenceScheduler;
   public:
 
 	ofxImageSequence();
@@ -92,12 +154,24 @@ class ofxImageSequence : public ofBaseHasTexture {
 	bool loadSequence(string prefix, string filetype, int startIndex, int endIndex, int numDigits);
     bool loadSequence(string folder);
 
+	/**
+	 *	Loads from a detected numbering pattern, generating the paths without listing the folder again.
+	 *	Missing numbers are skipped, so frame indices stay contiguous.
+	 */
+	bool loadSequence(const ofxImageSequencePattern& pattern);
+
 	void cancelLoad();
 	void preloadAllFrames();		//immediately loads all frames in the sequence, memory intensive but fastest scrubbing
 	void unloadSequence();			//clears out all frames and frees up memory
 
 	void setFrameRate(float rate); //used for getting frames by time, default is 30fps	
 
+	//when the sequence is shown at a lower rate than its own, or played faster, only every few frames
+	//are ever presented. with these set prefetch, tier windows and preloadAllFrames skip the frames in between
+	void setOutputFrameRate(float rate);	//rate frames are presented at, e.g. the display refresh rate. 0 (default) disables skipping
+	void setPlaybackSpeed(float speed);		//1.0 is normal speed, the sign is ignored
+	float getFrameStride();					//source frames advanced per presented frame
+
 	//these get textures, but also change the
 	OF_DEPRECATED_MSG("Use getTextureForFrame instead.",   ofTexture* getFrame(int index));		 //returns a frame at a given index
 	OF_DEPRECATED_MSG("Use getTextureForTime instead.",    ofTexture* getFrameForTime(float time)); //returns a frame at a given time, used setFrameRate to set time
@@ -119,8 +193,55 @@ class ofxImageSequence : public ofBaseHasTexture {
 	virtual ofTexture& getTexture();
 	virtual const ofTexture& getTexture() const;
 
-	virtual void setUseTexture(bool bUseTex){/* not used */};
-	virtual bool isUsingTexture() const{return true;}
+	//pass false before loading to run headless: frames are decoded but never uploaded and no GL calls are made
+	virtual void setUseTexture(bool bUseTex);
+	virtual bool isUsingTexture() const;
+
+	/**
+	 *	Returns the decoded pixels of any frame without uploading them, decoding it first if needed.
+	 *	The returned pointer pins the buffer, it stays valid even if the frame is demoted meanwhile,
+	 *	and is empty if the frame failed to load. Safe to call from any thread.
+	 */
+	shared_ptr<const ofPixels> getPixelsForFrame(int index);
+
+	/**
+	 *	Streams every frame through a pool of worker threads (0 uses one per core) and calls fn with its pixels.
+	 *	Frames already in RAM are reused, the others are decoded into temporary buffers released as soon as fn
+	 *	returns, so at most one frame per worker is held no matter how long the sequence is. Failed frames are skipped.
+	 *	fn is called concurrently unless ordered is true, in which case calls are serialized in frame order
+	 *	while decoding still runs ahead on the other workers. Blocks until all frames are processed.
+	 */
+	void forEachFrame(function<void(int, const ofPixels&)> fn, int numThreads = 0, bool ordered = false);
+
+	/**
+	 *	Batch pipeline for offline jobs. Frames are decoded and passed through process on the worker pool,
+	 *	which writes its result into the output pixels, and the results are handed to sink in frame order
+	 *	from the calling thread, e.g. to feed an encoder. Workers never run more than reorderFrames ahead
+	 *	of the sink (0 means two per worker) so memory stays proportional to the number of workers, not frames.
+	 *	Failed frames are skipped. Blocks until the sink has received every frame.
+	 */
+	void processFrames(function<void(int, const ofPixels&, ofPixels&)> process,
+					   function<void(int, ofPixels&)> sink,
+					   int numThreads = 0, int reorderFrames = 0);
+
+	/**
+	 *	Maps every frame to a value on the worker pool and folds the values into init.
+	 *	reduce must be associative and commutative since frames complete in any order, e.g.
+	 *
+	 *	float brightest = sequence.transformReduce(0.0f,
+	 *		[](int index, const ofPixels& pixels){ return averageBrightness(pixels); },
+	 *		[](float a, float b){ return MAX(a, b); });
+	 */
+	template<typename T, typename Transform, typename Reduce>
+	T transformReduce(T init, Transform transform, Reduce reduce, int numThreads = 0){
+		ofMutex resultMutex;
+		forEachFrame([&](int index, const ofPixels& pixels){
+			T value = transform(index, pixels);
+			ofScopedLock lock(resultMutex);
+			init = reduce(init, value);
+		}, numThreads, false);
+		return init;
+	}
 
 	int getFrameIndexAtPercent(float percent);	//returns percent (0.0 - 1.0) for a given frame
 	float getPercentAtFrameIndex(int index);	//returns a frame index for a percent
@@ -134,21 +255,250 @@ class ofxImageSequence : public ofBaseHasTexture {
 	bool isLoaded();						//returns true if the sequence has been loaded
 	bool isLoading();						//returns true if loading during thread
 	void loadFrame(int imageIndex);			//allows you to load (cache) a frame to avoid a stutter when loading. use this to "read ahead" if you want
+
+	//decodes count frames from startIndex in the background (negative count goes backwards, wrapping around)
+	//and moves the tier window there, for sequences that are about to start playing from that point
+	void prefetchFrames(int startIndex, int count);
 	
 	void setMinMagFilter(int minFilter, int magFilter);
 
+	/**
+	 *	Resamples every frame to width x height on the loader threads as it is decoded, so RAM, uploads and
+	 *	the disk cache only ever hold frames at the output size. A 0 width or height keeps the aspect ratio,
+	 *	0 for both (default) keeps the source size, and frames are never scaled up. Set before loading,
+	 *	getWidth and getHeight then return the target size.
+	 */
+	void setTargetSize(int width, int height, ofxImageSequenceFilter filter = OFX_IMAGE_SEQUENCE_FILTER_LANCZOS);
+
+	/**
+	 *	Colour transforms paid once per frame instead of once per draw. A LUT set before loading is applied
+	 *	on the loader threads right after decoding and resampling, so frames in RAM and in the disk cache are
+	 *	already graded. With a linear colour output frames are also expanded from sRGB to linear light on the
+	 *	thread that decodes them, and the decoded tier keeps that copy next to the 8 bit frame so uploads into
+	 *	the 16 bit or half float textures shaders composite from cost no conversion. The copy takes two (16 bit)
+	 *	or four (half float, held as float) times the frame size, and counts against the decoded tier budget.
+	 *	Set the output before loading; frames decoded under another output are converted as they upload.
+	 *	getPixelsForFrame, the disk cache and the shared cache still see 8 bit sRGB.
+	 */
+	bool loadColorLut(string cubePath);
+	void setColorLut(const ofxImageSequenceColorLut& lut);
+	void clearColorLut();
+	void setColorOutput(ofxImageSequenceColorOutput output);
+	ofxImageSequenceColorOutput getColorOutput();
+
+	/**
+	 *	Runs fn on every frame after it is decoded, resampled and graded, and before it is stored or uploaded,
+	 *	e.g. for keying or masking. The result is what every tier holds, so each frame is processed once.
+	 *	fn runs on the loader threads, possibly several at once, and on the main thread for frames that were
+	 *	not loaded in time, so it must be thread safe. Set before loading, an empty function removes it.
+	 *	Processed frames are never shared through a shared cache, each process decodes its own.
+	 */
+	void setFrameProcessor(function<void(ofPixels&, int)> fn);
+
+	/**
+	 *	Tiered storage. Each tier has a budget in bytes, 0 disables the tier and OFX_IMAGE_SEQUENCE_UNLIMITED
+	 *	keeps every frame that reaches it without demoting. By default only decoded frames are kept, unlimited,
+	 *	which is the classic behavior of holding everything that was ever loaded.
+	 *
+	 *	With bounded budgets a background thread keeps the frames nearest the playhead (biased in the direction
+	 *	of playback, wrapping around for loops) in each RAM tier, and setFrame uploads resident textures for the
+	 *	GPU tier. For example to keep the whole show warm compressed and one second hot:
+	 *
+	 *	sequence.setTierBudget(OFX_IMAGE_SEQUENCE_TIER_COMPRESSED, 2048*1024*1024ull);
+	 *	sequence.setTierBudget(OFX_IMAGE_SEQUENCE_TIER_DECODED, 30*1920*1080*4);
+	 *	sequence.setTierBudget(OFX_IMAGE_SEQUENCE_TIER_GPU, 8*1920*1080*4);
+	 */
+	void setTierBudget(ofxImageSequenceTier tier, uint64_t bytes);
+	uint64_t getTierBudget(ofxImageSequenceTier tier);
+	uint64_t getTierBytes(ofxImageSequenceTier tier);	//returns how many bytes a tier currently holds
+	ofxImageSequenceTier getFrameTier(int index);		//returns the hottest tier holding a frame
+	bool isFrameInTier(int index, ofxImageSequenceTier tier);
+	bool isFrameReady(int index);						//true when setFrame can show a frame without decoding it first
+	void setDiskCacheFolder(string folder);				//folder for the disk cache tier, can be shared between sequences
+	void setMaxUploadsPerFrame(int maxUploads);			//limits resident texture uploads per setFrame call, default 1
+	void setEvictionPolicy(ofxImageSequenceEviction eviction);		//how the decoded tier picks frames to drop, see ofxImageSequenceEviction.h
+	void setEvictionPolicy(shared_ptr<ofxImageSequenceEvictionPolicy> policy);	//a custom policy, NULL for the default window
+	void setSharedCache(ofxImageSequenceSharedCache* cache);	//shares full resolution decoded frames with other processes, NULL to stop
+	void setTrace(ofxImageSequenceTrace* trace, int sequenceId = 0);	//records every frame request under sequenceId, NULL to stop
+
+	/**
+	 *	Pinned frames stay decoded whatever the playhead, tier budgets and eviction policy do, for cue starts,
+	 *	poster frames and loop points that must show instantly. Frames not decoded yet are decoded in the
+	 *	background straight away, before any other tier work. A level above 0 pins a reduced proxy instead,
+	 *	each level halving width and height, which setFrame shows at once while the full frame is fetched.
+	 *	Pinned frames count against their own budget, unlimited by default, and pins past it are refused.
+	 *	Call after loading, pins are released when the sequence is unloaded or swapped.
+	 */
+	void pinFrames(int startIndex, int count, int level = 0);
+	void unpinFrames(int startIndex, int count);
+	bool isFramePinned(int index);
+	void setPinnedBudget(uint64_t bytes);
+	uint64_t getPinnedBytes();
+
+	/**
+	 *	Diagnostics, read from the frame table without locking it so they can be polled every frame without
+	 *	slowing playback down. Until isLoaded they report nothing, since a threaded load is still growing the
+	 *	table. Call from the main thread, see ofxImageSequenceOverlay for a ready made display.
+	 */
+	ofxImageSequenceFrameStatus getFrameStatus(int index);
+	bool isFrameInPrefetchWindow(int index);	//true for the frames the decoded tier is keeping around the playhead
+	ofxImageSequenceStats getStats();
+	void resetStats();
+
+	/**
+	 *	Seamless switching. prepareSequence loads another folder in the background while this one keeps
+	 *	playing, with the same settings: the folder is scanned, the first framesToPrime frames are decoded
+	 *	and, when the GPU tier has a budget, uploaded a few per frame. swapToPrepared then switches over
+	 *	atomically at the first frame boundary where no background tier work is in flight, starting at frame 0,
+	 *	and the old frames are released in the background. Don't run forEachFrame or processFrames across a swap.
+	 *	The trace and eviction policy belong to this sequence and carry on with the new frames, the policy
+	 *	starting over from the frames the swap brings in. Pins belong to the frames they were set on, so the
+	 *	swap releases them (logged) and the new frames have to be pinned again; the pinned budget carries over.
+	 */
+	void prepareSequence(string folder, int framesToPrime = 1);
+	bool isPrepared();			//returns true once the prepared sequence can be swapped in without a hitch
+	void swapToPrepared();		//swaps as soon as the prepared sequence is ready
+	bool isSwapPending();
+	void cancelPrepare();
+
+	/**
+	 *	Adaptive quality. The time spent loading each frame that had to be decoded is compared to the frame
+	 *	interval and when deadlines are being missed frames are decoded at a reduced level, each level halving
+	 *	width and height, up to maxLevel (at most 3). Once loads leave enough headroom the level steps back
+	 *	toward full resolution.
+	 *	Reduced frames still draw at the full sequence size. Every change is logged and notified through
+	 *	qualityLevelChanged with the new level.
+	 */
+	void enableAdaptiveQuality(bool enable, int maxLevel = 2);
+	int getQualityLevel();
+	ofEvent<int> qualityLevelChanged;
+
 	//Do not call directly
 	//called internally from threaded loader
 	void completeLoading();
 	bool preloadAllFilenames();		//searches for all filenames based on load input
 	float percentLoaded();
+	bool updateTiers();				//promotes or demotes one frame in the RAM tiers, returns false when there is nothing to do
+	shared_ptr<const ofPixels> acquirePixels(int index, bool store);	//resident pixels or a fresh decode, kept only if store is true
 
   protected:
 	ofxImageSequenceLoader* threadLoader;
+	ofxImageSequenceTierManager* tierManager;
+	ofxImageSequencePreparer* preparer;
+	ofxImageSequence* prepared;
+	bool swapPending;
+	std::thread releaser;	//frees the frames of the last sequence swapped out, joined before the next and on destruction
+
+	//frame table, one dense array per field
+	vector< shared_ptr<const ofPixels> > sequence;
+	vector< shared_ptr<ofxImageSequenceLinearFrame> > linearFrames;	//empty with sRGB output
+	ofxImageSequenceFilenames filenames;
+
+	//tiered storage, guarded by frameMutex since the tier manager works from its own thread
+	ofMutex frameMutex;
+	vector< shared_ptr<ofBuffer> > compressed;
+	vector<ofxImageSequenceFrameState> frameStates;	//bit per tier holding the frame, quality level of the decoded frame, failed bit and progress bits
+	map<int, ofTexture> residentTextures;
+	uint64_t tierBudgets[OFX_IMAGE_SEQUENCE_NUM_TIERS];
+	uint64_t tierBytes[OFX_IMAGE_SEQUENCE_NUM_TIERS];
+	int tierFrameCounts[OFX_IMAGE_SEQUENCE_NUM_TIERS];
+	std::atomic<uint64_t> decodedFrameBytes;
+	bool frameSizeEstimated;	//decodedFrameBytes, width and height scaled up from a reduced frame
+	string diskCacheFolder;
+	int maxUploadsPerFrame;
+	int tierPlayhead;
+	int playDirection;
+	deque<int> prefetchQueue;
+	deque<int> demoteQueue;	//frames to drop from the decoded tier on the tier manager thread
+	shared_ptr<ofxImageSequenceEvictionPolicy> evictionPolicy;
+
+	struct PinnedFrame {
+		int level;
+		uint64_t bytes;					//estimated until decoded
+		shared_ptr<const ofPixels> pixels;	//empty until decoded
+		shared_ptr<ofxImageSequenceLinearFrame> linear;
+	};
+	map<int, PinnedFrame> pinnedFrames;
+	uint64_t pinnedBudget;
+	uint64_t pinnedBytes;
+
+	float outputFrameRate;
+	float playbackSpeed;
+	std::atomic<float> frameStride;
+
+	bool adaptiveQuality;
+	std::atomic<int> qualityLevel;
+	int maxQualityLevel;
+	float averageLoadMicros;
+	int framesSinceQualityChange;
+
+	int targetWidth;
+	int targetHeight;
+	ofxImageSequenceFilter targetFilter;
+
+	ofxImageSequenceColorLut colorLut;
+	ofxImageSequenceColorOutput colorOutput;
+
+	function<void(ofPixels&, int)> frameProcessor;
+	ofxImageSequenceSharedCache* sharedCache;
+	ofxImageSequenceTrace* trace;
+	int traceId;
+
+	std::atomic<uint64_t> numHits;
+	std::atomic<uint64_t> numMisses;
+	std::atomic<uint64_t> numDecodes;
+	std::atomic<uint64_t> decodeMicros;
 
-	vector<ofPixels> sequence;
-	vector<string> filenames;
-	vector<bool> loadFailed;
+	bool decodeFrame(int index, ofPixels& pixels);			//thread safe, reads from the hottest RAM or disk tier available
+	bool decodeFrame(int index, ofPixels& pixels, int level);
+	shared_ptr<const ofPixels> decodePixels(int index, int level);	//through the shared cache when there is one, empty on failure
+	uint64_t getSharedFrameKey(int index);
+	void resampleToTarget(ofPixels& pixels);
+	shared_ptr<ofxImageSequenceLinearFrame> convertLinear(const ofPixels& pixels);	//empty with sRGB output
+	shared_ptr<ofxImageSequenceLinearFrame> storeDecodedFrame(int index, shared_ptr<const ofPixels> pixels, int level);	//returns the linear copy
+	uint64_t getDecodedBytes(int index);
+	void uploadPixels(ofTexture& target, const ofPixels& pixels, shared_ptr<ofxImageSequenceLinearFrame> linear);
+	void updateQualityLevel(uint64_t loadMicros);
+	void addFrame(string path);
+	void markFrameFailed(int index);
+	enum {
+		FRAME_LEVEL_SHIFT = 5,
+		FRAME_LEVEL_MASK = 3 << FRAME_LEVEL_SHIFT,
+		FRAME_FAILED = 1 << 7,
+		FRAME_QUEUED = 1 << 8,		//in the prefetch queue
+		FRAME_DECODING = 1 << 9,
+		FRAME_PINNED = 1 << 10,		//pinned pixels ready
+		FRAME_PIN_PENDING = 1 << 11,	//pinned, waiting for the tier manager to decode it
+		FRAME_HELD = 1 << 12		//held for a scheduler cue, never demoted or offered to the eviction policy
+	};
+	bool isFrameFailed(int index){ return (frameStates[index] & FRAME_FAILED) != 0; }
+	int getFrameLevel(int index){ return (frameStates[index] & FRAME_LEVEL_MASK) >> FRAME_LEVEL_SHIFT; }
+	void setFrameLevel(int index, int level){ frameStates[index] &= ~FRAME_LEVEL_MASK; frameStates[index] |= level << FRAME_LEVEL_SHIFT; }
+	void promoteFrame(int index, ofxImageSequenceTier tier);
+	void demoteFrame(int index, ofxImageSequenceTier tier);
+	void queueDemotion(int index);	//demotes a decoded frame from the tier manager, off the calling thread
+	bool holdFrame(int index);		//keeps a full resolution decoded frame in RAM, false if there is none
+	void releaseFrame(int index);	//lets the tiers demote a held frame again
+	void updateResidentTextures();
+	bool updateEvictedTier();
+	bool updatePinnedFrames();
+	void wakeTierManager();
+	void resetEvictionPolicy();
+	ofxImageSequenceEvictionContext getEvictionContext();
+	void updatePrepared(ofEventArgs& args);
+	bool swapContents(ofxImageSequence& other);
+	void startTierManager();
+	bool isTierBounded(ofxImageSequenceTier tier);
+	bool hasTierRoom(ofxImageSequenceTier tier, uint64_t bytes);
+	uint64_t getTierFrameBytes(ofxImageSequenceTier tier);
+	int getTierCapacity(ofxImageSequenceTier tier);
+	void updateFrameStride();
+	int getStrideOffset(int presentedFrames);
+	void getFramesNearPlayhead(int playhead, int direction, int count, vector<int>& frames);
+	bool isFrameNearPlayhead(int index, int playhead, int direction, int count);
+	string getDiskCachePath(int index);
+	bool writeDiskCache(int index, const ofPixels& pixels);
+	bool readDiskCache(int index, ofPixels& pixels);
 	int currentFrame;
 	ofTexture texture;
 	string extension;
@@ -157,6 +507,7 @@ class ofxImageSequence : public ofBaseHasTexture {
 	int curLoadFrame;
 	int maxFrames;
 	bool useThread;
+	bool useTexture;
 	bool loaded;
 
 	float width, height;
@@ -0,0 +1,293 @@
+/**
+ *  ofxImageSequenceColor.cpp
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofxImageSequenceColor.h"
+#include "ofxImageSequenceKernels.h"
+
+ofxImageSequenceColorLut::ofxImageSequenceColorLut()
+{
+	clear();
+}
+
+bool ofxImageSequenceColorLut::load(string path)
+{
+	ifstream file(ofToDataPath(path).c_str());
+	if(!file){
+		ofLogError("ofxImageSequenceColorLut::load") << "Could not open " << path;
+		return false;
+	}
+
+	int lutSize = 0;
+	bool lut3D = false;
+	vector<float> rgb;
+	string line;
+	while(getline(file, line)){
+		if(line.empty() || line[0] == '#'){
+			continue;
+		}
+		stringstream words(line);
+		string keyword;
+		words >> keyword;
+		if(keyword == "LUT_1D_SIZE" || keyword == "LUT_3D_SIZE"){
+			words >> lutSize;
+			lut3D = keyword == "LUT_3D_SIZE";
+		}
+		else if(keyword == "DOMAIN_MIN" || keyword == "DOMAIN_MAX"){
+			float r, g, b;
+			words >> r >> g >> b;
+			if(r != g || g != b || r != (keyword == "DOMAIN_MIN" ? 0.0f : 1.0f)){
+				ofLogWarning("ofxImageSequenceColorLut::load") << path << " has a domain other than 0-1, it is ignored";
+			}
+		}
+		else if(!keyword.empty() && (isdigit(keyword[0]) || keyword[0] == '-' || keyword[0] == '.')){
+			float g, b;
+			words >> g >> b;
+			rgb.push_back(ofToFloat(keyword));
+			rgb.push_back(g);
+			rgb.push_back(b);
+		}
+	}
+
+	int expected = lut3D ? lutSize*lutSize*lutSize : lutSize;
+	if(lutSize < 2 || rgb.size() != expected*3){
+		ofLogError("ofxImageSequenceColorLut::load") << path << " is not a valid .cube LUT";
+		return false;
+	}
+
+	if(lut3D){
+		set3D(rgb, lutSize);
+	}
+	else{
+		set1D(rgb, lutSize);
+	}
+	return true;
+}
+
+void ofxImageSequenceColorLut::set1D(const vector<float>& rgb, int _size)
+{
+	if(_size < 2 || rgb.size() != _size*3){
+		ofLogError("ofxImageSequenceColorLut::set1D") << "Expected " << _size << " rgb entries";
+		return;
+	}
+	table = rgb;
+	size = _size;
+	threeD = false;
+	bake();
+}
+
+void ofxImageSequenceColorLut::set3D(const vector<float>& rgb, int _size)
+{
+	if(_size < 2 || rgb.size() != _size*_size*_size*3){
+		ofLogError("ofxImageSequenceColorLut::set3D") << "Expected " << _size << "^3 rgb entries";
+		return;
+	}
+	table = rgb;
+	size = _size;
+	threeD = true;
+	bake();
+}
+
+void ofxImageSequenceColorLut::clear()
+{
+	table.clear();
+	size = 0;
+	threeD = false;
+	hash = 0;
+}
+
+bool ofxImageSequenceColorLut::isEmpty() const
+{
+	return size == 0;
+}
+
+bool ofxImageSequenceColorLut::is3D() const
+{
+	return threeD;
+}
+
+int ofxImageSequenceColorLut::getSize() const
+{
+	return size;
+}
+
+size_t ofxImageSequenceColorLut::getHash() const
+{
+	return hash;
+}
+
+static inline unsigned char toByte(float value)
+{
+	return (unsigned char)(ofClamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+void ofxImageSequenceColorLut::bake()
+{
+	std::hash<string> hashTable;
+	hash = hashTable(string((const char*)&table[0], table.size() * sizeof(float))) ^ (size << 1 | threeD);
+
+	for(int v = 0; v < 256; v++){
+		float position = v / 255.0f * (size - 1);
+		cells[v] = MIN((int)position, size - 2);
+		weights[v] = position - cells[v];
+	}
+
+	if(threeD){
+		return;
+	}
+	for(int c = 0; c < 3; c++){
+		for(int v = 0; v < 256; v++){
+			float low = table[cells[v]*3 + c];
+			float high = table[(cells[v] + 1)*3 + c];
+			curves[c][v] = toByte(low + (high - low) * weights[v]);
+		}
+	}
+}
+
+void ofxImageSequenceColorLut::apply(ofPixels& pixels) const
+{
+	if(isEmpty()){
+		return;
+	}
+	if(threeD){
+		apply3D(pixels);
+	}
+	else{
+		apply1D(pixels);
+	}
+}
+
+//curves the colour channels, only the first one of grayscale frames, leaving alpha alone
+template<int Channels>
+struct ofxImageSequenceCurveKernel {
+	static void run(ofPixels& pixels, const unsigned char (*curves)[256]){
+		const int colors = Channels < 3 ? 1 : 3;
+		int count = pixels.getWidth() * pixels.getHeight();
+		unsigned char* data = pixels.getData();
+		for(int i = 0; i < count; i++){
+			unsigned char* pixel = data + i * Channels;
+			for(int c = 0; c < colors; c++){
+				pixel[c] = curves[c][pixel[c]];
+			}
+		}
+	}
+};
+
+void ofxImageSequenceColorLut::apply1D(ofPixels& pixels) const
+{
+	ofxImageSequenceDispatchChannels<ofxImageSequenceCurveKernel>(pixels.getNumChannels(), pixels, curves);
+}
+
+template<int Channels>
+struct ofxImageSequenceLatticeKernel {
+	static void run(ofPixels& pixels, const float* lattice, int size, const int* cells, const float* weights){
+		if(Channels < 3){
+			return;
+		}
+		int count = pixels.getWidth() * pixels.getHeight();
+		int strideG = size * 3;
+		int strideB = size * size * 3;
+		unsigned char* data = pixels.getData();
+		for(int i = 0; i < count; i++){
+			unsigned char* pixel = data + i * Channels;
+			float wr = weights[pixel[0]], wg = weights[pixel[1]], wb = weights[pixel[2]];
+			const float* cell = lattice + cells[pixel[0]]*3 + cells[pixel[1]]*strideG + cells[pixel[2]]*strideB;
+			for(int c = 0; c < 3; c++){
+				float c00 = cell[c] + (cell[3 + c] - cell[c]) * wr;
+				float c10 = cell[strideG + c] + (cell[strideG + 3 + c] - cell[strideG + c]) * wr;
+				float c01 = cell[strideB + c] + (cell[strideB + 3 + c] - cell[strideB + c]) * wr;
+				float c11 = cell[strideB + strideG + c] + (cell[strideB + strideG + 3 + c] - cell[strideB + strideG + c]) * wr;
+				float c0 = c00 + (c10 - c00) * wg;
+				float c1 = c01 + (c11 - c01) * wg;
+				pixel[c] = toByte(c0 + (c1 - c0) * wb);
+			}
+		}
+	}
+};
+
+void ofxImageSequenceColorLut::apply3D(ofPixels& pixels) const
+{
+	if(pixels.getNumChannels() < 3){
+		ofLogWarning("ofxImageSequenceColorLut::apply") << "3D LUTs need rgb frames, leaving the frame untouched";
+		return;
+	}
+	ofxImageSequenceDispatchChannels<ofxImageSequenceLatticeKernel>(pixels.getNumChannels(), pixels, &table[0], size, cells, weights);
+}
+
+//sRGB decoding of every 8 bit value, built once
+struct ofxImageSequenceSrgbTables {
+	unsigned short linear16[256];
+	unsigned short alpha16[256];
+	float linearFloat[256];
+	float alphaFloat[256];
+
+	ofxImageSequenceSrgbTables(){
+		for(int v = 0; v < 256; v++){
+			float srgb = v / 255.0f;
+			float linear = srgb <= 0.04045f ? srgb / 12.92f : powf((srgb + 0.055f) / 1.055f, 2.4f);
+			linear16[v] = (unsigned short)(linear * 65535.0f + 0.5f);
+			alpha16[v] = v * 257;
+			linearFloat[v] = linear;
+			alphaFloat[v] = srgb;
+		}
+	}
+};
+
+static const ofxImageSequenceSrgbTables& getSrgbTables()
+{
+	static ofxImageSequenceSrgbTables tables;
+	return tables;
+}
+
+template<typename T>
+static void srgbToLinear(const ofPixels& src, ofPixels_<T>& dst, const T* linear, const T* alpha)
+{
+	int channels = src.getNumChannels();
+	if(dst.getWidth() != src.getWidth() || dst.getHeight() != src.getHeight() || dst.getNumChannels() != channels){
+		dst.allocate(src.getWidth(), src.getHeight(), channels);
+	}
+
+	//alpha is the 2nd channel of gray alpha and the 4th of rgba
+	int alphaChannel = channels == 2 || channels == 4 ? channels - 1 : -1;
+	const unsigned char* in = src.getData();
+	T* out = dst.getData();
+	int count = src.getWidth() * src.getHeight() * channels;
+	for(int i = 0; i < count; i++){
+		out[i] = linear[in[i]];
+	}
+	if(alphaChannel >= 0){
+		for(int i = alphaChannel; i < count; i += channels){
+			out[i] = alpha[in[i]];
+		}
+	}
+}
+
+void ofxImageSequenceSrgbToLinear(const ofPixels& src, ofShortPixels& dst)
+{
+	const ofxImageSequenceSrgbTables& tables = getSrgbTables();
+	srgbToLinear(src, dst, tables.linear16, tables.alpha16);
+}
+
+void ofxImageSequenceSrgbToLinear(const ofPixels& src, ofFloatPixels& dst)
+{
+	const ofxImageSequenceSrgbTables& tables = getSrgbTables();
+	srgbToLinear(src, dst, tables.linearFloat, tables.alphaFloat);
+}
+
+ofxImageSequenceLinearFrame::ofxImageSequenceLinearFrame(const ofPixels& src, ofxImageSequenceColorOutput _output)
+{
+	output = _output;
+	if(output == OFX_IMAGE_SEQUENCE_COLOR_LINEAR_16){
+		ofxImageSequenceSrgbToLinear(src, shortPixels);
+	}
+	else if(output == OFX_IMAGE_SEQUENCE_COLOR_LINEAR_HALF){
+		ofxImageSequenceSrgbToLinear(src, floatPixels);
+	}
+}
+
+uint64_t ofxImageSequenceLinearFrame::getBytes() const
+{
+	return shortPixels.size() * sizeof(unsigned short) + floatPixels.size() * sizeof(float);
+}
@@ -0,0 +1,73 @@
+/**
+ *  ofxImageSequenceColor.h
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  Table driven colour transforms applied while frames load.
+ *
+ *  ofxImageSequenceColorLut holds a 1D or 3D LUT, set from code or read from an Adobe/Resolve .cube file,
+ *  and applies it to 8 bit frames. 1D LUTs are baked to one 256 entry table per channel so applying them
+ *  is a single lookup per byte. 3D LUTs are interpolated trilinearly, with the lattice cell and weights of
+ *  every input value precomputed.
+ *
+ *  ofxImageSequenceSrgbToLinear expands 8 bit sRGB to linear light at 16 bit or float precision through
+ *  a 256 entry table, alpha is scaled but not transformed.
+ */
+
+#pragma once
+
+#include "ofMain.h"
+
+//what getTexture holds, frames on disk and in the shared cache always stay 8 bit sRGB
+enum ofxImageSequenceColorOutput {
+	OFX_IMAGE_SEQUENCE_COLOR_SRGB = 0,		//8 bit as decoded
+	OFX_IMAGE_SEQUENCE_COLOR_LINEAR_16,		//16 bit unsigned linear light
+	OFX_IMAGE_SEQUENCE_COLOR_LINEAR_HALF	//half float linear light
+};
+
+class ofxImageSequenceColorLut {
+  public:
+
+	ofxImageSequenceColorLut();
+
+	bool load(string path);								//reads a .cube file, 1D or 3D
+	void set1D(const vector<float>& rgb, int size);		//size rgb triplets, 0.0 - 1.0
+	void set3D(const vector<float>& rgb, int size);		//size^3 rgb triplets, red varying fastest like .cube
+	void clear();
+
+	bool isEmpty() const;
+	bool is3D() const;
+	int getSize() const;
+	size_t getHash() const;		//identifies the table contents, e.g. to key caches of transformed frames
+
+	void apply(ofPixels& pixels) const;	//transforms the first three channels in place, grayscale only takes 1D LUTs
+
+  protected:
+	void bake();
+	void apply1D(ofPixels& pixels) const;
+	void apply3D(ofPixels& pixels) const;
+
+	int size;
+	bool threeD;
+	vector<float> table;
+	size_t hash;
+
+	unsigned char curves[3][256];	//1D LUT baked per channel
+	int cells[256];					//3D lattice cell below each input value
+	float weights[256];				//and the weight of the cell above it
+};
+
+void ofxImageSequenceSrgbToLinear(const ofPixels& src, ofShortPixels& dst);
+void ofxImageSequenceSrgbToLinear(const ofPixels& src, ofFloatPixels& dst);
+
+//linear light copy of a decoded frame, made once by the thread that decoded it so uploads only copy
+struct ofxImageSequenceLinearFrame {
+	ofxImageSequenceLinearFrame(const ofPixels& src, ofxImageSequenceColorOutput output);
+
+	ofxImageSequenceColorOutput output;
+	ofShortPixels shortPixels;	//for OFX_IMAGE_SEQUENCE_COLOR_LINEAR_16
+	ofFloatPixels floatPixels;	//for OFX_IMAGE_SEQUENCE_COLOR_LINEAR_HALF
+	uint64_t getBytes() const;
+};
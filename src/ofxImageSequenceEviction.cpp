@@ -0,0 +1,266 @@
+/**
+ *  ofxImageSequenceEviction.cpp
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofxImageSequenceEviction.h"
+
+shared_ptr<ofxImageSequenceEvictionPolicy> ofxImageSequenceCreateEvictionPolicy(ofxImageSequenceEviction eviction)
+{
+	switch(eviction){
+		case OFX_IMAGE_SEQUENCE_EVICT_LRU:		return shared_ptr<ofxImageSequenceEvictionPolicy>(new ofxImageSequenceLruPolicy());
+		case OFX_IMAGE_SEQUENCE_EVICT_CLOCK:	return shared_ptr<ofxImageSequenceEvictionPolicy>(new ofxImageSequenceClockPolicy());
+		case OFX_IMAGE_SEQUENCE_EVICT_ARC:		return shared_ptr<ofxImageSequenceEvictionPolicy>(new ofxImageSequenceArcPolicy());
+		case OFX_IMAGE_SEQUENCE_EVICT_PLAYHEAD:	return shared_ptr<ofxImageSequenceEvictionPolicy>(new ofxImageSequencePlayheadPolicy());
+		default:								return shared_ptr<ofxImageSequenceEvictionPolicy>();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxImageSequenceLruPolicy::reset()
+{
+	recency.clear();
+	positions.clear();
+}
+
+void ofxImageSequenceLruPolicy::inserted(int frame)
+{
+	if(positions.count(frame) == 0){
+		recency.push_front(frame);
+		positions[frame] = recency.begin();
+	}
+}
+
+void ofxImageSequenceLruPolicy::removed(int frame)
+{
+	map<int, list<int>::iterator>::iterator position = positions.find(frame);
+	if(position != positions.end()){
+		recency.erase(position->second);
+		positions.erase(position);
+	}
+}
+
+void ofxImageSequenceLruPolicy::accessed(int frame)
+{
+	map<int, list<int>::iterator>::iterator position = positions.find(frame);
+	if(position != positions.end()){
+		recency.splice(recency.begin(), recency, position->second);
+	}
+}
+
+int ofxImageSequenceLruPolicy::selectVictim(const ofxImageSequenceEvictionContext& /*context*/)
+{
+	return recency.empty() ? -1 : recency.back();
+}
+
+//--------------------------------------------------------------
+enum {
+	CLOCK_RESIDENT = 1,
+	CLOCK_REFERENCED = 2
+};
+
+ofxImageSequenceClockPolicy::ofxImageSequenceClockPolicy()
+{
+	reset();
+}
+
+void ofxImageSequenceClockPolicy::reset()
+{
+	states.clear();
+	hand = 0;
+	numResident = 0;
+}
+
+void ofxImageSequenceClockPolicy::inserted(int frame)
+{
+	if(frame >= (int)states.size()){
+		states.resize(frame + 1, 0);
+	}
+	if((states[frame] & CLOCK_RESIDENT) == 0){
+		numResident++;
+	}
+	states[frame] = CLOCK_RESIDENT | CLOCK_REFERENCED;
+}
+
+void ofxImageSequenceClockPolicy::removed(int frame)
+{
+	if(frame < (int)states.size() && (states[frame] & CLOCK_RESIDENT) != 0){
+		states[frame] = 0;
+		numResident--;
+	}
+}
+
+void ofxImageSequenceClockPolicy::accessed(int frame)
+{
+	if(frame < (int)states.size() && (states[frame] & CLOCK_RESIDENT) != 0){
+		states[frame] |= CLOCK_REFERENCED;
+	}
+}
+
+//sweeps the hand over the frames, clearing reference bits, until it finds a resident frame without one
+int ofxImageSequenceClockPolicy::selectVictim(const ofxImageSequenceEvictionContext& /*context*/)
+{
+	if(numResident == 0){
+		return -1;
+	}
+	int size = states.size();
+	for(int i = 0; i <= size * 2; i++){
+		int frame = hand;
+		hand = (hand + 1) % size;
+		if((states[frame] & CLOCK_RESIDENT) == 0){
+			continue;
+		}
+		if((states[frame] & CLOCK_REFERENCED) != 0){
+			states[frame] &= ~CLOCK_REFERENCED;
+			continue;
+		}
+		return frame;
+	}
+	return -1;
+}
+
+//--------------------------------------------------------------
+ofxImageSequenceArcPolicy::ofxImageSequenceArcPolicy()
+{
+	reset();
+}
+
+void ofxImageSequenceArcPolicy::reset()
+{
+	for(int i = 0; i < NUM_LISTS; i++){
+		lists[i].clear();
+	}
+	positions.clear();
+	target = 0;
+}
+
+void ofxImageSequenceArcPolicy::move(int frame, List to)
+{
+	map<int, pair<List, list<int>::iterator> >::iterator position = positions.find(frame);
+	if(position != positions.end()){
+		lists[position->second.first].erase(position->second.second);
+	}
+	lists[to].push_front(frame);
+	positions[frame] = make_pair(to, lists[to].begin());
+}
+
+//ghosts remember as many frames as the cache holds, so T1 + B1 <= c and all four lists <= 2c
+void ofxImageSequenceArcPolicy::trimGhosts()
+{
+	size_t capacity = MAX(lists[T1].size() + lists[T2].size(), (size_t)1);
+	while(!lists[B1].empty() && lists[T1].size() + lists[B1].size() > capacity){
+		positions.erase(lists[B1].back());
+		lists[B1].pop_back();
+	}
+	while(!lists[B2].empty() && lists[T1].size() + lists[T2].size() + lists[B1].size() + lists[B2].size() > capacity * 2){
+		positions.erase(lists[B2].back());
+		lists[B2].pop_back();
+	}
+}
+
+//a ghost hit means its list was evicted too early, so the target size of T1 moves toward it
+void ofxImageSequenceArcPolicy::inserted(int frame)
+{
+	map<int, pair<List, list<int>::iterator> >::iterator position = positions.find(frame);
+	List from = position != positions.end() ? position->second.first : NONE;
+	float capacity = lists[T1].size() + lists[T2].size() + 1;
+	if(from == B1){
+		target = MIN(target + MAX((float)lists[B2].size() / lists[B1].size(), 1.0f), capacity);
+		move(frame, T2);
+	}
+	else if(from == B2){
+		target = MAX(target - MAX((float)lists[B1].size() / lists[B2].size(), 1.0f), 0.0f);
+		move(frame, T2);
+	}
+	else if(from == NONE){
+		move(frame, T1);
+	}
+	trimGhosts();
+}
+
+void ofxImageSequenceArcPolicy::removed(int frame)
+{
+	map<int, pair<List, list<int>::iterator> >::iterator position = positions.find(frame);
+	if(position == positions.end()){
+		return;
+	}
+	if(position->second.first == T1){
+		move(frame, B1);
+	}
+	else if(position->second.first == T2){
+		move(frame, B2);
+	}
+	trimGhosts();
+}
+
+void ofxImageSequenceArcPolicy::accessed(int frame)
+{
+	map<int, pair<List, list<int>::iterator> >::iterator position = positions.find(frame);
+	if(position != positions.end() && (position->second.first == T1 || position->second.first == T2)){
+		move(frame, T2);
+	}
+}
+
+int ofxImageSequenceArcPolicy::selectVictim(const ofxImageSequenceEvictionContext& /*context*/)
+{
+	if(!lists[T1].empty() && (lists[T1].size() > target || lists[T2].empty())){
+		return lists[T1].back();
+	}
+	return lists[T2].empty() ? -1 : lists[T2].back();
+}
+
+//--------------------------------------------------------------
+ofxImageSequencePlayheadPolicy::ofxImageSequencePlayheadPolicy(bool _loop)
+{
+	loop = _loop;
+}
+
+void ofxImageSequencePlayheadPolicy::reset()
+{
+	resident.clear();
+}
+
+void ofxImageSequencePlayheadPolicy::inserted(int frame)
+{
+	resident.insert(frame);
+}
+
+void ofxImageSequencePlayheadPolicy::removed(int frame)
+{
+	resident.erase(frame);
+}
+
+void ofxImageSequencePlayheadPolicy::accessed(int /*frame*/)
+{
+}
+
+int ofxImageSequencePlayheadPolicy::getDistance(int frame, const ofxImageSequenceEvictionContext& context)
+{
+	int total = MAX(context.numFrames, 1);
+	int ahead = (frame - context.playhead) * context.direction;
+	if(loop){
+		return (ahead % total + total) % total;
+	}
+	return ahead >= 0 ? ahead : total - ahead;
+}
+
+//the frame needed last, which for a loop is the one just played
+int ofxImageSequencePlayheadPolicy::selectVictim(const ofxImageSequenceEvictionContext& context)
+{
+	int victim = -1;
+	int farthest = -1;
+	for(set<int>::iterator it = resident.begin(); it != resident.end(); ++it){
+		int distance = getDistance(*it, context);
+		if(distance > farthest){
+			farthest = distance;
+			victim = *it;
+		}
+	}
+	return victim;
+}
+
+bool ofxImageSequencePlayheadPolicy::shouldReplace(int frame, int victim, const ofxImageSequenceEvictionContext& context)
+{
+	return getDistance(frame, context) < getDistance(victim, context);
+}
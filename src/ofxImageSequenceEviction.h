@@ -0,0 +1,127 @@
+/**
+ *  ofxImageSequenceEviction.h
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  Eviction policies for the decoded tier. By default the tier keeps a window of frames around the
+ *  playhead; with a policy set it is a cache instead: frames stay once decoded, and while the tier is
+ *  over budget the policy picks which one goes. The playback window is still prefetched into free room,
+ *  and in place of resident frames when the policy prefers the incoming one.
+ *
+ *	LRU			evicts the frame requested longest ago
+ *	CLOCK		second chance approximation of LRU, cheaper to maintain
+ *	ARC			balances recency and frequency, resisting scans through the sequence
+ *	PLAYHEAD	evicts the frame farthest from the playhead along the playback direction, wrapping around
+ *				for loops. A loop longer than the cache then hits on every frame the cache can hold,
+ *				where LRU evicts each frame just before it comes around again and never hits
+ *
+ *	sequence.setTierBudget(OFX_IMAGE_SEQUENCE_TIER_DECODED, 200*1920*1080*4);
+ *	sequence.setEvictionPolicy(OFX_IMAGE_SEQUENCE_EVICT_PLAYHEAD);
+ *
+ *  Custom policies derive from ofxImageSequenceEvictionPolicy. Its methods are called from the main and
+ *  loader threads with the sequence's frame table locked, so they must be quick and never call back into
+ *  the sequence.
+ */
+
+#pragma once
+
+#include "ofMain.h"
+
+enum ofxImageSequenceEviction {
+	OFX_IMAGE_SEQUENCE_EVICT_WINDOW = 0,	//no policy, the tier keeps the frames nearest the playhead
+	OFX_IMAGE_SEQUENCE_EVICT_LRU,
+	OFX_IMAGE_SEQUENCE_EVICT_CLOCK,
+	OFX_IMAGE_SEQUENCE_EVICT_ARC,
+	OFX_IMAGE_SEQUENCE_EVICT_PLAYHEAD
+};
+
+struct ofxImageSequenceEvictionContext {
+	int playhead;		//last frame requested
+	int direction;		//1 forwards, -1 backwards
+	int numFrames;
+};
+
+class ofxImageSequenceEvictionPolicy {
+  public:
+	virtual ~ofxImageSequenceEvictionPolicy(){}
+
+	virtual void reset() = 0;				//nothing resident anymore
+	virtual void inserted(int frame) = 0;	//frame became resident
+	virtual void removed(int frame) = 0;	//frame was evicted or released
+	virtual void accessed(int frame) = 0;	//resident frame requested again
+
+	//resident frame to evict next, -1 if there is none
+	virtual int selectVictim(const ofxImageSequenceEvictionContext& context) = 0;
+
+	//whether a frame of the playback window should be prefetched in place of the victim, false by default
+	virtual bool shouldReplace(int /*frame*/, int /*victim*/, const ofxImageSequenceEvictionContext& /*context*/){ return false; }
+};
+
+//NULL for OFX_IMAGE_SEQUENCE_EVICT_WINDOW
+shared_ptr<ofxImageSequenceEvictionPolicy> ofxImageSequenceCreateEvictionPolicy(ofxImageSequenceEviction eviction);
+
+class ofxImageSequenceLruPolicy : public ofxImageSequenceEvictionPolicy {
+  public:
+	void reset();
+	void inserted(int frame);
+	void removed(int frame);
+	void accessed(int frame);
+	int selectVictim(const ofxImageSequenceEvictionContext& context);
+
+  protected:
+	list<int> recency;	//most recent first
+	map<int, list<int>::iterator> positions;
+};
+
+class ofxImageSequenceClockPolicy : public ofxImageSequenceEvictionPolicy {
+  public:
+	ofxImageSequenceClockPolicy();
+	void reset();
+	void inserted(int frame);
+	void removed(int frame);
+	void accessed(int frame);
+	int selectVictim(const ofxImageSequenceEvictionContext& context);
+
+  protected:
+	vector<unsigned char> states;	//resident bit and reference bit per frame
+	int hand;
+	int numResident;
+};
+
+class ofxImageSequenceArcPolicy : public ofxImageSequenceEvictionPolicy {
+  public:
+	ofxImageSequenceArcPolicy();
+	void reset();
+	void inserted(int frame);
+	void removed(int frame);
+	void accessed(int frame);
+	int selectVictim(const ofxImageSequenceEvictionContext& context);
+
+  protected:
+	enum List { T1 = 0, T2, B1, B2, NUM_LISTS, NONE = NUM_LISTS };
+	void move(int frame, List to);
+	void trimGhosts();
+
+	list<int> lists[NUM_LISTS];		//resident seen once and more than once, then their evicted ghosts, most recent first
+	map<int, pair<List, list<int>::iterator> > positions;
+	float target;	//adapted size of T1
+};
+
+class ofxImageSequencePlayheadPolicy : public ofxImageSequenceEvictionPolicy {
+  public:
+	ofxImageSequencePlayheadPolicy(bool loop = true);	//without looping, frames already played are evicted first
+	void reset();
+	void inserted(int frame);
+	void removed(int frame);
+	void accessed(int frame);
+	int selectVictim(const ofxImageSequenceEvictionContext& context);
+	bool shouldReplace(int frame, int victim, const ofxImageSequenceEvictionContext& context);
+
+	int getDistance(int frame, const ofxImageSequenceEvictionContext& context);	//frames until frame is played
+
+  protected:
+	set<int> resident;
+	bool loop;
+};
@@ -0,0 +1,61 @@
+/**
+ *  ofxImageSequenceFilenames.cpp
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofxImageSequenceFilenames.h"
+
+static const uint32_t WHOLE_PATH = 1u << 31;
+
+void ofxImageSequenceFilenames::push_back(const string& path)
+{
+	size_t slash = path.find_last_of("/\\");
+	size_t folderLength = slash == string::npos ? 0 : slash + 1;
+	if(offsets.empty()){
+		directory = path.substr(0, folderLength);
+	}
+
+	uint32_t offset = names.size();
+	if(folderLength == directory.size() && path.compare(0, folderLength, directory) == 0){
+		names.append(path, folderLength, string::npos);
+	}
+	else{
+		names.append(path);
+		offset |= WHOLE_PATH;
+	}
+	offsets.push_back(offset);
+}
+
+string ofxImageSequenceFilenames::operator[](int index) const
+{
+	uint32_t start = offsets[index] & ~WHOLE_PATH;
+	uint32_t end = index + 1 < offsets.size() ? offsets[index + 1] & ~WHOLE_PATH : names.size();
+	string path;
+	if((offsets[index] & WHOLE_PATH) == 0){
+		path = directory;
+	}
+	return path.append(names, start, end - start);
+}
+
+size_t ofxImageSequenceFilenames::size() const
+{
+	return offsets.size();
+}
+
+bool ofxImageSequenceFilenames::empty() const
+{
+	return offsets.empty();
+}
+
+void ofxImageSequenceFilenames::clear()
+{
+	directory.clear();
+	names.clear();
+	offsets.clear();
+}
+
+string ofxImageSequenceFilenames::getDirectory() const
+{
+	return directory;
+}
@@ -0,0 +1,34 @@
+/**
+ *  ofxImageSequenceFilenames.h
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  Compact list of frame paths. The folder shared by the frames is stored once and the file names are
+ *  packed back to back in a single string, so each frame costs a 4 byte offset plus its file name instead
+ *  of a heap allocated copy of the full path. Paths outside the shared folder are kept whole.
+ *  Reads like a vector<string>, paths are rebuilt on access.
+ */
+
+#pragma once
+
+#include "ofMain.h"
+
+class ofxImageSequenceFilenames {
+  public:
+
+	void push_back(const string& path);
+	string operator[](int index) const;
+
+	size_t size() const;
+	bool empty() const;
+	void clear();
+
+	string getDirectory() const;	//the folder shared by the frames, with a trailing separator
+
+  protected:
+	string directory;
+	string names;				//file names back to back
+	vector<uint32_t> offsets;	//start of each name, the top bit marks a whole path outside the directory
+};
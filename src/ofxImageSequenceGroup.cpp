@@ -0,0 +1,206 @@
+/**
+ *  ofxImageSequenceGroup.cpp
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofxImageSequenceGroup.h"
+
+ofxImageSequenceGroup::ofxImageSequenceGroup()
+{
+	totalFrames = 0;
+	currentFrame = -1;
+	targetFrame = -1;
+	prefetchedFrom = -1;
+	playDirection = 1;
+	frameRate = 30.0f;
+	prefetchFrames = 0;
+	maxWait = 0.5f;
+	waitingSince = 0;
+	synchronousLoads = 0;
+}
+
+bool ofxImageSequenceGroup::addFolder(string folder)
+{
+	shared_ptr<ofxImageSequence> sequence(new ofxImageSequence());
+	sequence->setFrameRate(frameRate);
+	if(!sequence->loadSequence(folder)){
+		ofLogError("ofxImageSequenceGroup::addFolder") << "Could not load " << folder;
+		return false;
+	}
+	ownedSequences.push_back(sequence);
+	addSequence(sequence.get());
+	return true;
+}
+
+void ofxImageSequenceGroup::addSequence(ofxImageSequence* sequence)
+{
+	if(sequence->getTotalFrames() == 0){
+		ofLogError("ofxImageSequenceGroup::addSequence") << "Adding an empty sequence, load it first";
+		return;
+	}
+	if(!sequences.empty() && sequence->getTotalFrames() != totalFrames){
+		ofLogWarning("ofxImageSequenceGroup::addSequence") << "Members have different lengths, playing the shortest "
+			<< MIN(totalFrames, sequence->getTotalFrames()) << " frames";
+	}
+	sequences.push_back(sequence);
+	totalFrames = sequences.size() == 1 ? sequence->getTotalFrames() : MIN(totalFrames, sequence->getTotalFrames());
+	prefetchedFrom = -1;
+}
+
+void ofxImageSequenceGroup::clear()
+{
+	sequences.clear();
+	ownedSequences.clear();
+	totalFrames = 0;
+	currentFrame = -1;
+	targetFrame = -1;
+	prefetchedFrom = -1;
+}
+
+void ofxImageSequenceGroup::setFrameRate(float rate)
+{
+	frameRate = rate;
+	for(int i = 0; i < sequences.size(); i++){
+		sequences[i]->setFrameRate(rate);
+	}
+}
+
+void ofxImageSequenceGroup::setPrefetchFrames(int frames)
+{
+	prefetchFrames = MAX(frames, 0);
+}
+
+void ofxImageSequenceGroup::setMaxWait(float seconds)
+{
+	maxWait = seconds;
+}
+
+void ofxImageSequenceGroup::setFrame(int index)
+{
+	if(totalFrames == 0){
+		ofLogError("ofxImageSequenceGroup::setFrame") << "Calling setFrame on an empty group.";
+		return;
+	}
+
+	if(index < 0){
+		ofLogError("ofxImageSequenceGroup::setFrame") << "Asking for negative index.";
+		return;
+	}
+
+	index %= totalFrames;
+
+	if(index != targetFrame){
+		//track which way the playhead travels, taking the shortest way around for loops
+		if(targetFrame != -1){
+			int delta = index - targetFrame;
+			if(delta > totalFrames/2) delta -= totalFrames;
+			if(delta < -totalFrames/2) delta += totalFrames;
+			playDirection = delta >= 0 ? 1 : -1;
+		}
+		//the wait starts when the group falls behind, not at every new request, since during playback
+		//the requested frame moves on every frame and the wait would never run out
+		if(targetFrame == currentFrame){
+			waitingSince = ofGetElapsedTimef();
+		}
+		targetFrame = index;
+	}
+
+	prefetch(index);
+
+	if(index == currentFrame){
+		return;
+	}
+	if(isFrameReady(index)){
+		present(index);
+	}
+	else if(maxWait >= 0 && ofGetElapsedTimef() - waitingSince >= maxWait){
+		ofLogVerbose("ofxImageSequenceGroup::setFrame") << "Held back for " << maxWait << "s, loading frame " << index << " synchronously";
+		synchronousLoads++;
+		present(index);
+	}
+}
+
+//prefetches the same frames on every member, again once the playhead has used up half of the last prefetch
+void ofxImageSequenceGroup::prefetch(int index)
+{
+	int count = prefetchFrames > 0 ? prefetchFrames : MAX((int)frameRate, 1);
+	if(prefetchedFrom != -1){
+		int travelled = (((index - prefetchedFrom) * playDirection) % totalFrames + totalFrames) % totalFrames;
+		if(travelled < count / 2){
+			return;
+		}
+	}
+	prefetchedFrom = index;
+	for(int i = 0; i < sequences.size(); i++){
+		sequences[i]->prefetchFrames(index, count * playDirection);
+	}
+}
+
+void ofxImageSequenceGroup::present(int index)
+{
+	for(int i = 0; i < sequences.size(); i++){
+		sequences[i]->setFrame(index);
+	}
+	currentFrame = index;
+	waitingSince = ofGetElapsedTimef();
+}
+
+void ofxImageSequenceGroup::setFrameForTime(float time)
+{
+	float totalTime = totalFrames / frameRate;
+	float percent = time / totalTime;
+	return setFrameAtPercent(percent);
+}
+
+void ofxImageSequenceGroup::setFrameAtPercent(float percent)
+{
+	setFrame(getFrameIndexAtPercent(percent));
+}
+
+bool ofxImageSequenceGroup::isFrameReady(int index)
+{
+	for(int i = 0; i < sequences.size(); i++){
+		if(!sequences[i]->isFrameReady(index)){
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ofxImageSequenceGroup::isWaiting()
+{
+	return targetFrame != currentFrame;
+}
+
+int ofxImageSequenceGroup::getTotalFrames()
+{
+	return totalFrames;
+}
+
+float ofxImageSequenceGroup::getLengthInSeconds()
+{
+	return totalFrames / frameRate;
+}
+
+int ofxImageSequenceGroup::getFrameIndexAtPercent(float percent)
+{
+	if (percent < 0.0 || percent > 1.0) percent -= floor(percent);
+
+	return MIN((int)(percent*totalFrames), totalFrames-1);
+}
+
+int ofxImageSequenceGroup::getNumSequences()
+{
+	return sequences.size();
+}
+
+ofxImageSequence& ofxImageSequenceGroup::getSequence(int index)
+{
+	return *sequences[index];
+}
+
+ofTexture& ofxImageSequenceGroup::getTexture(int index)
+{
+	return sequences[index]->getTexture();
+}
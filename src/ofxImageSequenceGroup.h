@@ -0,0 +1,79 @@
+/**
+ *  ofxImageSequenceGroup.h
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  ofxImageSequenceGroup plays several sequences in lock step, for example left and right eye or
+ *  colour and matte, so they always show the same frame index.
+ *
+ *  The group is driven by one clock, through setFrame, setFrameForTime or setFrameAtPercent, and
+ *  prefetches the frames ahead of the playhead on every member at once. A requested frame is only
+ *  presented once all members have it ready; until then every member keeps showing the previous
+ *  frame, so they never tear apart. If the group has been held back for the maximum wait, counted from
+ *  the last frame it presented however often the requested frame moves on meanwhile, the current one
+ *  is loaded synchronously on all members so playback can't hang on frames that never arrive in time.
+ *
+ *	group.addFolder("left");
+ *	group.addFolder("right");
+ *	group.setFrameForTime(ofGetElapsedTimef());
+ *	group.getTexture(0).draw(0, 0);
+ *	group.getTexture(1).draw(1920, 0);
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxImageSequence.h"
+
+class ofxImageSequenceGroup {
+  public:
+
+	ofxImageSequenceGroup();
+
+	bool addFolder(string folder);					//loads a folder and adds it, the group owns it
+	void addSequence(ofxImageSequence* sequence);	//adds an already loaded sequence, not owned
+	void clear();
+
+	void setFrameRate(float rate);			//used for getting frames by time, default is 30fps
+	void setPrefetchFrames(int frames);		//how many frames ahead to prefetch on every member, default one second
+	void setMaxWait(float seconds);			//how long a frame is held back before loading it synchronously, default 0.5, negative waits forever
+
+	//these request a frame, which is presented on every member once they all have it
+	void setFrame(int index);
+	void setFrameForTime(float time);
+	void setFrameAtPercent(float percent);
+
+	bool isFrameReady(int index);			//returns true if every member has the frame ready
+	bool isWaiting();						//returns true while the requested frame is held back
+	int getSynchronousLoads(){ return synchronousLoads; };	//frames presented after the maximum wait
+
+	int getCurrentFrame(){ return currentFrame; };	//the frame every member shows
+	int getTargetFrame(){ return targetFrame; };	//the last frame requested
+	int getTotalFrames();					//frames of the shortest member
+	float getLengthInSeconds();
+	int getFrameIndexAtPercent(float percent);
+
+	int getNumSequences();
+	ofxImageSequence& getSequence(int index);
+	ofTexture& getTexture(int index);
+
+  protected:
+	vector<ofxImageSequence*> sequences;
+	vector< shared_ptr<ofxImageSequence> > ownedSequences;
+	int totalFrames;
+
+	int currentFrame;
+	int targetFrame;
+	int prefetchedFrom;		//playhead of the last joint prefetch, -1 if none
+	int playDirection;
+	float frameRate;
+	int prefetchFrames;
+	float maxWait;
+	float waitingSince;		//when the group last presented a frame or fell behind the requested one
+	int synchronousLoads;
+
+	void prefetch(int index);
+	void present(int index);
+};
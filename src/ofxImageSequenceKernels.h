@@ -0,0 +1,33 @@
+/**
+ *  ofxImageSequenceKernels.h
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  Per format dispatch for the pixel kernels. Kernels are class templates over the channel count with a
+ *  static run function, so the inner loops see a compile time stride and no per pixel branches, which lets
+ *  the compiler unroll and vectorize them. The runtime channel count is switched on once per frame:
+ *
+ *	template<int Channels> struct InvertKernel {
+ *		static void run(ofPixels& pixels){ ... }
+ *	};
+ *	ofxImageSequenceDispatchChannels<InvertKernel>(pixels.getNumChannels(), pixels);
+ */
+
+#pragma once
+
+#include "ofMain.h"
+
+//returns false for channel counts without a kernel
+template<template<int> class Kernel, typename... Args>
+bool ofxImageSequenceDispatchChannels(int channels, Args&&... args)
+{
+	switch(channels){
+		case 1: Kernel<1>::run(std::forward<Args>(args)...); return true;
+		case 2: Kernel<2>::run(std::forward<Args>(args)...); return true;
+		case 3: Kernel<3>::run(std::forward<Args>(args)...); return true;
+		case 4: Kernel<4>::run(std::forward<Args>(args)...); return true;
+		default: return false;
+	}
+}
@@ -0,0 +1,197 @@
+/**
+ *  ofxImageSequenceOverlay.cpp
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofxImageSequenceOverlay.h"
+
+static const float LINE_HEIGHT = 14;
+static const float WINDOW_HEIGHT = 3;
+static const float SPACING = 8;
+
+//which status a column shows when it covers several frames
+static int getStatusRank(ofxImageSequenceFrameStatus status)
+{
+	switch(status){
+		case OFX_IMAGE_SEQUENCE_FRAME_FAILED:		return 6;
+		case OFX_IMAGE_SEQUENCE_FRAME_DECODING:		return 5;
+		case OFX_IMAGE_SEQUENCE_FRAME_QUEUED:		return 4;
+		case OFX_IMAGE_SEQUENCE_FRAME_NOT_LOADED:	return 3;
+		case OFX_IMAGE_SEQUENCE_FRAME_COMPRESSED:	return 2;
+		case OFX_IMAGE_SEQUENCE_FRAME_DECODED:		return 1;
+		default:									return 0;
+	}
+}
+
+static void addQuad(ofMesh& mesh, float x, float y, float w, float h, const ofColor& color)
+{
+	ofVec3f corners[6] = { ofVec3f(x, y), ofVec3f(x + w, y), ofVec3f(x + w, y + h),
+						   ofVec3f(x, y), ofVec3f(x + w, y + h), ofVec3f(x, y + h) };
+	for(int i = 0; i < 6; i++){
+		mesh.addVertex(corners[i]);
+		mesh.addColor(color);
+	}
+}
+
+ofxImageSequenceOverlay::ofxImageSequenceOverlay()
+{
+	barHeight = 12;
+	showLegend = true;
+	mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+}
+
+void ofxImageSequenceOverlay::addSequence(ofxImageSequence* sequence, string label)
+{
+	Entry entry;
+	entry.sequence = sequence;
+	entry.label = label;
+	sequences.push_back(entry);
+}
+
+void ofxImageSequenceOverlay::removeSequence(ofxImageSequence* sequence)
+{
+	for(int i = sequences.size() - 1; i >= 0; i--){
+		if(sequences[i].sequence == sequence){
+			sequences.erase(sequences.begin() + i);
+		}
+	}
+}
+
+void ofxImageSequenceOverlay::clear()
+{
+	sequences.clear();
+}
+
+void ofxImageSequenceOverlay::setBarHeight(float height)
+{
+	barHeight = MAX(height, 1.0f);
+}
+
+void ofxImageSequenceOverlay::setShowLegend(bool show)
+{
+	showLegend = show;
+}
+
+float ofxImageSequenceOverlay::getHeight()
+{
+	float height = sequences.size() * (LINE_HEIGHT + barHeight + WINDOW_HEIGHT + SPACING);
+	return showLegend ? height + LINE_HEIGHT : height;
+}
+
+void ofxImageSequenceOverlay::draw(float x, float y, float width)
+{
+	ofPushStyle();
+	ofFill();
+	for(int i = 0; i < sequences.size(); i++){
+		drawSequence(sequences[i], x, y, width);
+		y += LINE_HEIGHT + barHeight + WINDOW_HEIGHT + SPACING;
+	}
+	if(showLegend){
+		drawLegend(x, y);
+	}
+	ofPopStyle();
+}
+
+void ofxImageSequenceOverlay::drawSequence(Entry& entry, float x, float y, float width)
+{
+	ofxImageSequence& sequence = *entry.sequence;
+	string text = entry.label.empty() ? "" : entry.label + "  ";
+
+	//a threaded load is still growing the frame table, nothing in it can be read yet
+	if(!sequence.isLoaded()){
+		ofSetColor(255);
+		ofDrawBitmapString(text + (sequence.isLoading() ? "loading" : "not loaded"), x, y + LINE_HEIGHT - 3);
+		ofSetColor(40);
+		ofDrawRectangle(x, y + LINE_HEIGHT, width, barHeight + WINDOW_HEIGHT);
+		return;
+	}
+
+	ofxImageSequenceStats stats = sequence.getStats();
+	int total = sequence.getTotalFrames();
+
+	uint64_t requests = stats.hits + stats.misses;
+	text += "hits " + (requests > 0 ? ofToString(100.0 * stats.hits / requests, 1) + "%" : string("-"));
+	text += "  decode " + (stats.decodes > 0 ? ofToString(stats.decodeMicros / 1000.0 / stats.decodes, 1) + " ms" : string("-"));
+	text += "  RAM " + ofToString(stats.decodedBytes / (1024.0 * 1024.0), 1) + " MB";
+	text += "  GPU " + ofToString(stats.gpuBytes / (1024.0 * 1024.0), 1) + " MB";
+	text += "  frame " + ofToString(sequence.getCurrentFrame()) + "/" + ofToString(total);
+	if(stats.frameCounts[OFX_IMAGE_SEQUENCE_FRAME_FAILED] > 0){
+		text += "  failed " + ofToString(stats.frameCounts[OFX_IMAGE_SEQUENCE_FRAME_FAILED]);
+	}
+	ofSetColor(255);
+	ofDrawBitmapString(text, x, y + LINE_HEIGHT - 3);
+	y += LINE_HEIGHT;
+
+	ofSetColor(40);
+	ofDrawRectangle(x, y, width, barHeight + WINDOW_HEIGHT);
+	if(total == 0){
+		return;
+	}
+
+	//a column per frame, or per run of frames when there are more frames than pixels
+	int columns = MIN(total, MAX((int)width, 1));
+	float columnWidth = width / columns;
+	mesh.clear();
+	for(int c = 0; c < columns; c++){
+		int first = (int)((uint64_t)c * total / columns);
+		int last = (int)((uint64_t)(c + 1) * total / columns);
+		ofxImageSequenceFrameStatus status = sequence.getFrameStatus(first);
+		bool inWindow = false;
+		for(int i = first; i < last; i++){
+			ofxImageSequenceFrameStatus frameStatus = sequence.getFrameStatus(i);
+			if(getStatusRank(frameStatus) > getStatusRank(status)){
+				status = frameStatus;
+			}
+			inWindow = inWindow || sequence.isFrameInPrefetchWindow(i);
+		}
+		addQuad(mesh, x + c * columnWidth, y, columnWidth, barHeight, getStatusColor(status));
+		if(inWindow){
+			addQuad(mesh, x + c * columnWidth, y + barHeight, columnWidth, WINDOW_HEIGHT, ofColor(255, 255, 255, 160));
+		}
+	}
+	mesh.draw();
+
+	float playhead = x + (sequence.getCurrentFrame() + 0.5f) * width / total;
+	ofSetColor(255);
+	ofDrawLine(playhead, y - 2, playhead, y + barHeight + WINDOW_HEIGHT + 2);
+}
+
+void ofxImageSequenceOverlay::drawLegend(float x, float y)
+{
+	for(int i = 0; i < OFX_IMAGE_SEQUENCE_NUM_FRAME_STATUS; i++){
+		ofxImageSequenceFrameStatus status = (ofxImageSequenceFrameStatus)i;
+		string name = getStatusName(status);
+		ofSetColor(getStatusColor(status));
+		ofDrawRectangle(x, y + 2, 10, 10);
+		ofSetColor(255);
+		ofDrawBitmapString(name, x + 14, y + LINE_HEIGHT - 3);
+		x += 14 + name.size() * 8 + 12;
+	}
+}
+
+ofColor ofxImageSequenceOverlay::getStatusColor(ofxImageSequenceFrameStatus status)
+{
+	switch(status){
+		case OFX_IMAGE_SEQUENCE_FRAME_QUEUED:		return ofColor(90, 90, 200);
+		case OFX_IMAGE_SEQUENCE_FRAME_DECODING:		return ofColor(240, 200, 40);
+		case OFX_IMAGE_SEQUENCE_FRAME_COMPRESSED:	return ofColor(40, 130, 140);
+		case OFX_IMAGE_SEQUENCE_FRAME_DECODED:		return ofColor(60, 180, 75);
+		case OFX_IMAGE_SEQUENCE_FRAME_GPU:			return ofColor(170, 240, 120);
+		case OFX_IMAGE_SEQUENCE_FRAME_FAILED:		return ofColor(220, 40, 40);
+		default:									return ofColor(70);
+	}
+}
+
+string ofxImageSequenceOverlay::getStatusName(ofxImageSequenceFrameStatus status)
+{
+	switch(status){
+		case OFX_IMAGE_SEQUENCE_FRAME_QUEUED:		return "queued";
+		case OFX_IMAGE_SEQUENCE_FRAME_DECODING:		return "decoding";
+		case OFX_IMAGE_SEQUENCE_FRAME_COMPRESSED:	return "compressed";
+		case OFX_IMAGE_SEQUENCE_FRAME_DECODED:		return "in RAM";
+		case OFX_IMAGE_SEQUENCE_FRAME_GPU:			return "on GPU";
+		case OFX_IMAGE_SEQUENCE_FRAME_FAILED:		return "failed";
+		default:									return "not loaded";
+	}
+}
@@ -0,0 +1,60 @@
+/**
+ *  ofxImageSequenceOverlay.h
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  ofxImageSequenceOverlay draws what each sequence holds right now, to see at a glance why a show
+ *  stutters on site. Every sequence gets a timeline bar with a column per frame, coloured by its
+ *  status, the playhead as a white line and the frames the decoded tier keeps around it underlined.
+ *  Above each bar are its hit rate, mean decode time and the memory its decoded and GPU tiers hold.
+ *
+ *	overlay.addSequence(&intro, "intro");
+ *	overlay.addSequence(&loop, "loop");
+ *	...
+ *	overlay.draw(20, ofGetHeight() - overlay.getHeight() - 20, ofGetWidth() - 40);
+ *
+ *  Everything is read through ofxImageSequence::getFrameStatus and getStats, which never lock the frame
+ *  table, so the overlay can stay up during a show without slowing the loaders down. Sequences still
+ *  loading show an empty bar until they are loaded. When a sequence has
+ *  more frames than the bar has pixels, a column shows the state that matters most among its frames:
+ *  failed, decoding or queued first, otherwise the coldest, so a single missing frame is never hidden.
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxImageSequence.h"
+
+class ofxImageSequenceOverlay {
+  public:
+	ofxImageSequenceOverlay();
+
+	void addSequence(ofxImageSequence* sequence, string label = "");
+	void removeSequence(ofxImageSequence* sequence);
+	void clear();
+
+	void setBarHeight(float height);	//default 12
+	void setShowLegend(bool show);		//a colour key under the bars, on by default
+
+	void draw(float x, float y, float width);
+	float getHeight();	//of everything draw renders
+
+	static ofColor getStatusColor(ofxImageSequenceFrameStatus status);
+	static string getStatusName(ofxImageSequenceFrameStatus status);
+
+  protected:
+	struct Entry {
+		ofxImageSequence* sequence;
+		string label;
+	};
+
+	void drawSequence(Entry& entry, float x, float y, float width);
+	void drawLegend(float x, float y);
+
+	vector<Entry> sequences;
+	float barHeight;
+	bool showLegend;
+	ofMesh mesh;	//reused between draws
+};
@@ -0,0 +1,197 @@
+/**
+ *  ofxImageSequencePattern.cpp
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofxImageSequencePattern.h"
+
+ofxImageSequencePattern::ofxImageSequencePattern()
+{
+	numDigits = 0;
+	startIndex = 0;
+	endIndex = -1;
+}
+
+//splits path/to/frame_0042.png into path/to/frame_, 42, 4 digits, padded
+bool ofxImageSequencePattern::parse(string path, string& stem, int& number, int& digits, bool& padded)
+{
+	size_t dot = path.find_last_of('.');
+	size_t slash = path.find_last_of("/\\");
+	if(dot == string::npos || (slash != string::npos && dot < slash)){
+		dot = path.size();
+	}
+
+	size_t first = dot;
+	while(first > 0 && isdigit(path[first - 1])){
+		first--;
+	}
+	digits = dot - first;
+	if(digits == 0 || digits > 9){
+		return false;
+	}
+
+	stem = path.substr(0, first);
+	number = ofToInt(path.substr(first, digits));
+	padded = digits > 1 && path[first] == '0';
+	return true;
+}
+
+bool ofxImageSequencePattern::detect(string folder, string _extension)
+{
+	*this = ofxImageSequencePattern();
+
+	if(!ofDirectory::doesDirectoryExist(folder)){
+		ofLogError("ofxImageSequencePattern::detect") << "Could not find folder " << folder;
+		return false;
+	}
+
+	ofDirectory dir;
+	if(_extension != ""){
+		dir.allowExt(_extension);
+	}
+	int numFiles = dir.listDir(folder);
+
+	//files numbered the same way, keyed by stem and extension
+	struct Group {
+		vector<int> numbers;
+		int minDigits;
+		int maxDigits;
+		bool padded;
+	};
+	map< pair<string, string>, Group > groups;
+	for(int i = 0; i < numFiles; i++){
+		string path = dir.getPath(i);
+		string stem;
+		int number, digits;
+		bool padded;
+		if(!parse(path, stem, number, digits, padded)){
+			continue;
+		}
+
+		pair<string, string> key(stem, ofFilePath::getFileExt(path));
+		map< pair<string, string>, Group >::iterator it = groups.find(key);
+		if(it == groups.end()){
+			Group group;
+			group.minDigits = digits;
+			group.maxDigits = digits;
+			group.padded = false;
+			it = groups.insert(make_pair(key, group)).first;
+		}
+		Group& group = it->second;
+		group.numbers.push_back(number);
+		group.minDigits = MIN(group.minDigits, digits);
+		group.maxDigits = MAX(group.maxDigits, digits);
+		group.padded |= padded;
+	}
+
+	map< pair<string, string>, Group >::iterator largest = groups.end();
+	for(map< pair<string, string>, Group >::iterator it = groups.begin(); it != groups.end(); ++it){
+		if(largest == groups.end() || it->second.numbers.size() > largest->second.numbers.size()){
+			largest = it;
+		}
+	}
+	if(largest == groups.end()){
+		ofLogError("ofxImageSequencePattern::detect") << "No numbered files found in " << folder;
+		return false;
+	}
+	if(largest->second.numbers.size() < numFiles){
+		ofLogNotice("ofxImageSequencePattern::detect") << "Using " << largest->second.numbers.size() << " of the "
+			<< numFiles << " files in " << folder << ", the others are numbered differently";
+	}
+
+	Group& group = largest->second;
+	prefix = largest->first.first;
+	extension = largest->first.second;
+	//padded numbers can outgrow their width, unpadded ones of a single width print the same either way
+	numDigits = group.padded || group.minDigits == group.maxDigits ? group.minDigits : 0;
+
+	vector<int>& numbers = group.numbers;
+	sort(numbers.begin(), numbers.end());
+	numbers.erase(unique(numbers.begin(), numbers.end()), numbers.end());
+	startIndex = numbers.front();
+	endIndex = numbers.back();
+	for(int i = 1; i < numbers.size(); i++){
+		if(numbers[i] - numbers[i-1] > 1){
+			gaps.push_back(make_pair(numbers[i-1] + 1, numbers[i] - 1));
+		}
+	}
+	return true;
+}
+
+bool ofxImageSequencePattern::probe(string samplePath)
+{
+	*this = ofxImageSequencePattern();
+
+	int number, digits;
+	bool padded;
+	if(!parse(samplePath, prefix, number, digits, padded)){
+		ofLogError("ofxImageSequencePattern::probe") << samplePath << " has no frame number";
+		return false;
+	}
+	extension = ofFilePath::getFileExt(samplePath);
+	numDigits = padded ? digits : 0;
+	if(!ofFile::doesFileExist(getPath(number))){
+		ofLogError("ofxImageSequencePattern::probe") << "Could not find " << samplePath;
+		return false;
+	}
+
+	//gallop outward from the sample, then binary search the boundary
+	for(int direction = 1; direction >= -1; direction -= 2){
+		int found = number;
+		int step = 1;
+		while(found + step*direction >= 0 && ofFile::doesFileExist(getPath(found + step*direction))){
+			found += step*direction;
+			step *= 2;
+		}
+		int missing = found + step*direction;
+		while(abs(missing - found) > 1){
+			int middle = (found + missing) / 2;
+			if(middle >= 0 && ofFile::doesFileExist(getPath(middle))){
+				found = middle;
+			}
+			else{
+				missing = middle;
+			}
+		}
+		if(direction > 0){
+			endIndex = found;
+		}
+		else{
+			startIndex = found;
+		}
+	}
+	return true;
+}
+
+bool ofxImageSequencePattern::isValid() const
+{
+	return endIndex >= startIndex;
+}
+
+string ofxImageSequencePattern::getPath(int number) const
+{
+	char digits[16];
+	sprintf(digits, "%0*d", numDigits, number);
+	return prefix + digits + (extension.empty() ? "" : "." + extension);
+}
+
+int ofxImageSequencePattern::getNumFrames() const
+{
+	return isValid() ? endIndex - startIndex + 1 - getNumMissing() : 0;
+}
+
+int ofxImageSequencePattern::getNumMissing() const
+{
+	int missing = 0;
+	for(int i = 0; i < gaps.size(); i++){
+		missing += gaps[i].second - gaps[i].first + 1;
+	}
+	return missing;
+}
+
+bool ofxImageSequencePattern::isMissing(int number) const
+{
+	vector< pair<int, int> >::const_iterator it = upper_bound(gaps.begin(), gaps.end(), make_pair(number, INT_MAX));
+	return it != gaps.begin() && (it - 1)->second >= number;
+}
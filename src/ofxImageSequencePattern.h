@@ -0,0 +1,51 @@
+/**
+ *  ofxImageSequencePattern.h
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  ofxImageSequencePattern infers the numbering of a sequence, prefix, digit count, extension and
+ *  range, so it can be loaded by generating paths instead of listing its folder every time.
+ *
+ *  detect reads the folder names once and keeps the largest group of files numbered the same way,
+ *  recording the missing numbers as ranges. probe starts from one known file and finds the first and
+ *  last numbers with a logarithmic number of existence checks, for sequences known to have no gaps.
+ *
+ *	ofxImageSequencePattern pattern;
+ *	if(pattern.detect("shots/intro", "png")){
+ *		for(int i = 0; i < pattern.gaps.size(); i++){
+ *			ofLogWarning() << "missing frames " << pattern.gaps[i].first << " to " << pattern.gaps[i].second;
+ *		}
+ *		sequence.loadSequence(pattern);
+ *	}
+ */
+
+#pragma once
+
+#include "ofMain.h"
+
+class ofxImageSequencePattern {
+  public:
+
+	ofxImageSequencePattern();
+
+	bool detect(string folder, string extension = "");		//one listing of the folder, extension limits the files considered
+	bool probe(string samplePath);							//a few existence checks around one file of the sequence
+
+	bool isValid() const;
+	string getPath(int number) const;		//path of the file with that frame number
+	int getNumFrames() const;				//frames present, the range minus the gaps
+	int getNumMissing() const;
+	bool isMissing(int number) const;
+
+	string prefix;		//path up to the frame number, e.g. "shots/intro/frame_"
+	string extension;	//without the dot
+	int numDigits;		//zero padded width, 0 when numbers aren't padded
+	int startIndex;
+	int endIndex;
+	vector< pair<int, int> > gaps;	//missing numbers as first, last ranges in ascending order
+
+  protected:
+	bool parse(string path, string& stem, int& number, int& digits, bool& padded);
+};
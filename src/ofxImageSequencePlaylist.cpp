@@ -0,0 +1,234 @@
+/**
+ *  ofxImageSequencePlaylist.cpp
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofxImageSequencePlaylist.h"
+
+ofxImageSequencePlaylist::ofxImageSequencePlaylist()
+{
+	totalFrames = 0;
+	currentFrame = 0;
+	currentSequence = -1;
+	prefetchedSequence = -1;
+	playDirection = 1;
+	frameRate = 30.0f;
+	loop = true;
+	prefetchFrames = 0;
+}
+
+bool ofxImageSequencePlaylist::addFolder(string folder)
+{
+	shared_ptr<ofxImageSequence> sequence(new ofxImageSequence());
+	sequence->setFrameRate(frameRate);
+	if(!sequence->loadSequence(folder)){
+		ofLogError("ofxImageSequencePlaylist::addFolder") << "Could not load " << folder;
+		return false;
+	}
+	ownedSequences.push_back(sequence);
+	addSequence(sequence.get());
+	return true;
+}
+
+void ofxImageSequencePlaylist::addSequence(ofxImageSequence* sequence)
+{
+	if(sequence->getTotalFrames() == 0){
+		ofLogError("ofxImageSequencePlaylist::addSequence") << "Adding an empty sequence, load it first";
+		return;
+	}
+	sequences.push_back(sequence);
+	firstFrames.push_back(totalFrames);
+	totalFrames += sequence->getTotalFrames();
+}
+
+void ofxImageSequencePlaylist::clear()
+{
+	sequences.clear();
+	ownedSequences.clear();
+	firstFrames.clear();
+	totalFrames = 0;
+	currentFrame = 0;
+	currentSequence = -1;
+	prefetchedSequence = -1;
+}
+
+void ofxImageSequencePlaylist::setFrameRate(float rate)
+{
+	frameRate = rate;
+	for(int i = 0; i < sequences.size(); i++){
+		sequences[i]->setFrameRate(rate);
+	}
+}
+
+void ofxImageSequencePlaylist::setLoop(bool _loop)
+{
+	loop = _loop;
+}
+
+void ofxImageSequencePlaylist::setPrefetchFrames(int frames)
+{
+	prefetchFrames = MAX(frames, 0);
+}
+
+ofTexture& ofxImageSequencePlaylist::getTextureForFrame(int index)
+{
+	setFrame(index);
+	return getTexture();
+}
+
+ofTexture& ofxImageSequencePlaylist::getTextureForTime(float time)
+{
+	setFrameForTime(time);
+	return getTexture();
+}
+
+ofTexture& ofxImageSequencePlaylist::getTextureForPercent(float percent)
+{
+	setFrameAtPercent(percent);
+	return getTexture();
+}
+
+void ofxImageSequencePlaylist::setFrame(int index)
+{
+	if(totalFrames == 0){
+		ofLogError("ofxImageSequencePlaylist::setFrame") << "Calling setFrame on an empty playlist.";
+		return;
+	}
+
+	if(index < 0){
+		ofLogError("ofxImageSequencePlaylist::setFrame") << "Asking for negative index.";
+		return;
+	}
+
+	index %= totalFrames;
+
+	//track which way the playhead travels, taking the shortest way around for loops
+	int delta = index - currentFrame;
+	if(delta > totalFrames/2) delta -= totalFrames;
+	if(delta < -totalFrames/2) delta += totalFrames;
+	if(delta != 0){
+		playDirection = delta > 0 ? 1 : -1;
+	}
+
+	int sequenceIndex = getSequenceIndexForFrame(index);
+	int localFrame = index - firstFrames[sequenceIndex];
+	if(sequenceIndex != currentSequence){
+		currentSequence = sequenceIndex;
+		prefetchedSequence = -1;
+	}
+
+	sequences[sequenceIndex]->setFrame(localFrame);
+	currentFrame = index;
+
+	prefetchAround(sequenceIndex, localFrame);
+}
+
+//starts warming the neighbour sequence once the playhead gets close to a boundary
+void ofxImageSequencePlaylist::prefetchAround(int sequenceIndex, int localFrame)
+{
+	int count = prefetchFrames > 0 ? prefetchFrames : MAX((int)frameRate, 1);
+	int length = sequences[sequenceIndex]->getTotalFrames();
+
+	bool nearBoundary = playDirection > 0 ? length - localFrame <= count : localFrame < count;
+	if(!nearBoundary){
+		return;
+	}
+
+	int neighbour = sequenceIndex + playDirection;
+	if(neighbour < 0 || neighbour >= sequences.size()){
+		if(!loop){
+			return;
+		}
+		neighbour = (neighbour + sequences.size()) % sequences.size();
+	}
+
+	if(neighbour == prefetchedSequence || neighbour == sequenceIndex){
+		return;
+	}
+	prefetchedSequence = neighbour;
+
+	ofxImageSequence* next = sequences[neighbour];
+	if(playDirection > 0){
+		next->prefetchFrames(0, count);
+	}
+	else{
+		next->prefetchFrames(next->getTotalFrames()-1, -count);
+	}
+}
+
+void ofxImageSequencePlaylist::setFrameForTime(float time)
+{
+	float totalTime = totalFrames / frameRate;
+	float percent = time / totalTime;
+	return setFrameAtPercent(percent);
+}
+
+void ofxImageSequencePlaylist::setFrameAtPercent(float percent)
+{
+	setFrame(getFrameIndexAtPercent(percent));
+}
+
+ofTexture& ofxImageSequencePlaylist::getTexture()
+{
+	if(currentSequence == -1){
+		return emptyTexture;
+	}
+	return sequences[currentSequence]->getTexture();
+}
+
+const ofTexture& ofxImageSequencePlaylist::getTexture() const
+{
+	if(currentSequence == -1){
+		return emptyTexture;
+	}
+	return ((const ofxImageSequence*)sequences[currentSequence])->getTexture();
+}
+
+int ofxImageSequencePlaylist::getFrameIndexAtPercent(float percent)
+{
+	if (percent < 0.0 || percent > 1.0) percent -= floor(percent);
+
+	return MIN((int)(percent*totalFrames), totalFrames-1);
+}
+
+float ofxImageSequencePlaylist::getPercentAtFrameIndex(int index)
+{
+	return ofMap(index, 0, totalFrames-1, 0, 1.0, true);
+}
+
+int ofxImageSequencePlaylist::getTotalFrames()
+{
+	return totalFrames;
+}
+
+float ofxImageSequencePlaylist::getLengthInSeconds()
+{
+	return totalFrames / frameRate;
+}
+
+float ofxImageSequencePlaylist::getWidth()
+{
+	return currentSequence == -1 ? 0 : sequences[currentSequence]->getWidth();
+}
+
+float ofxImageSequencePlaylist::getHeight()
+{
+	return currentSequence == -1 ? 0 : sequences[currentSequence]->getHeight();
+}
+
+int ofxImageSequencePlaylist::getNumSequences()
+{
+	return sequences.size();
+}
+
+ofxImageSequence& ofxImageSequencePlaylist::getSequence(int index)
+{
+	return *sequences[index];
+}
+
+int ofxImageSequencePlaylist::getSequenceIndexForFrame(int index)
+{
+	vector<int>::iterator it = upper_bound(firstFrames.begin(), firstFrames.end(), index);
+	return MAX((int)(it - firstFrames.begin()) - 1, 0);
+}
@@ -0,0 +1,80 @@
+/**
+ *  ofxImageSequencePlaylist.h
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  ofxImageSequencePlaylist chains several sequences, for example reel1/, reel2/, reel3/, into one
+ *  virtual frame range that is accessed like a single ofxImageSequence, by index, time or percent.
+ *
+ *  When the playhead gets within the prefetch distance of the end of a sequence, the start of the next
+ *  one (or of the first one when looping) is prefetched in the background, and the same going backwards,
+ *  so playback runs across folder boundaries without a stall.
+ *
+ *	playlist.addFolder("reel1");
+ *	playlist.addFolder("reel2");
+ *	playlist.getTextureForTime(ofGetElapsedTimef()).draw(0, 0);
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxImageSequence.h"
+
+class ofxImageSequencePlaylist : public ofBaseHasTexture {
+  public:
+
+	ofxImageSequencePlaylist();
+
+	bool addFolder(string folder);					//loads a folder and appends it, the playlist owns it
+	void addSequence(ofxImageSequence* sequence);	//appends an already loaded sequence, not owned
+	void clear();
+
+	void setFrameRate(float rate);			//used for getting frames by time, default is 30fps
+	void setLoop(bool loop);				//whether prefetch wraps from the last sequence to the first, default true
+	void setPrefetchFrames(int frames);		//how many frames of the next sequence to prefetch, default one second
+
+	ofTexture& getTextureForFrame(int index);
+	ofTexture& getTextureForTime(float time);
+	ofTexture& getTextureForPercent(float percent);
+
+	void setFrame(int index);
+	void setFrameForTime(float time);
+	void setFrameAtPercent(float percent);
+
+	virtual ofTexture& getTexture();
+	virtual const ofTexture& getTexture() const;
+	virtual void setUseTexture(bool bUseTex){/* set on each sequence before loading */};
+	virtual bool isUsingTexture() const{return true;}
+
+	int getFrameIndexAtPercent(float percent);
+	float getPercentAtFrameIndex(int index);
+
+	int getCurrentFrame(){ return currentFrame; };
+	int getTotalFrames();
+	float getLengthInSeconds();
+	float getWidth();						//returns the width/height of the current sequence
+	float getHeight();
+
+	int getNumSequences();
+	ofxImageSequence& getSequence(int index);
+	int getSequenceIndexForFrame(int index);	//which sequence holds a frame of the playlist
+
+  protected:
+	vector<ofxImageSequence*> sequences;
+	vector< shared_ptr<ofxImageSequence> > ownedSequences;
+	vector<int> firstFrames;		//playlist index of the first frame of each sequence
+	int totalFrames;
+
+	int currentFrame;
+	int currentSequence;
+	int prefetchedSequence;
+	int playDirection;
+	float frameRate;
+	bool loop;
+	int prefetchFrames;
+	ofTexture emptyTexture;
+
+	void prefetchAround(int sequenceIndex, int localFrame);
+};
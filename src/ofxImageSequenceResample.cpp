@@ -0,0 +1,203 @@
+/**
+ *  ofxImageSequenceResample.cpp
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofxImageSequenceResample.h"
+#include "ofxImageSequenceKernels.h"
+
+//weights are 1.14 fixed point, enough precision for 8 bit channels without overflowing 32 bit sums
+static const int WEIGHT_BITS = 14;
+static const int WEIGHT_ONE = 1 << WEIGHT_BITS;
+
+//contributing source pixels for every output pixel of one pass
+struct ofxImageSequenceTaps {
+	int maxTaps;
+	vector<int> first;		//first source pixel
+	vector<int> count;		//number of source pixels
+	vector<int> weights;	//maxTaps weights per output pixel
+};
+
+static double filterKernel(double x, ofxImageSequenceFilter filter)
+{
+	if(filter == OFX_IMAGE_SEQUENCE_FILTER_BOX){
+		return x >= -0.5 && x < 0.5 ? 1.0 : 0.0;
+	}
+	if(x == 0.0){
+		return 1.0;
+	}
+	if(x <= -3.0 || x >= 3.0){
+		return 0.0;
+	}
+	double px = PI * x;
+	return 3.0 * sin(px) * sin(px / 3.0) / (px * px);
+}
+
+static void computeTaps(int srcSize, int dstSize, ofxImageSequenceFilter filter, ofxImageSequenceTaps& taps)
+{
+	double scale = (double)srcSize / dstSize;
+	double filterScale = MAX(scale, 1.0);	//widen the kernel when shrinking so every source pixel contributes
+	double support = (filter == OFX_IMAGE_SEQUENCE_FILTER_BOX ? 0.5 : 3.0) * filterScale;
+
+	taps.maxTaps = (int)ceil(support) * 2 + 1;
+	taps.first.resize(dstSize);
+	taps.count.resize(dstSize);
+	taps.weights.assign(dstSize * taps.maxTaps, 0);
+
+	vector<double> weights(taps.maxTaps);
+	for(int i = 0; i < dstSize; i++){
+		double center = (i + 0.5) * scale;
+		int first = MAX((int)(center - support + 0.5), 0);
+		int last = MIN((int)(center + support + 0.5), srcSize);
+		int count = MIN(last - first, taps.maxTaps);
+
+		double total = 0;
+		for(int j = 0; j < count; j++){
+			weights[j] = filterKernel((first + j + 0.5 - center) / filterScale, filter);
+			total += weights[j];
+		}
+
+		int* fixed = &taps.weights[i * taps.maxTaps];
+		for(int j = 0; j < count; j++){
+			fixed[j] = (int)floor(weights[j] / total * WEIGHT_ONE + 0.5);
+		}
+		taps.first[i] = first;
+		taps.count[i] = count;
+	}
+}
+
+static inline unsigned char clampChannel(int value)
+{
+	value >>= WEIGHT_BITS;
+	return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+template<int Channels>
+struct ofxImageSequenceHorizontalKernel {
+	static void run(const ofPixels& src, ofPixels& dst, const ofxImageSequenceTaps& taps){
+		int width = dst.getWidth();
+		int height = src.getHeight();
+		int srcStride = src.getWidth() * Channels;
+		const unsigned char* in = src.getData();
+		unsigned char* out = dst.getData();
+		for(int y = 0; y < height; y++){
+			const unsigned char* row = in + y * srcStride;
+			unsigned char* outRow = out + y * width * Channels;
+			for(int x = 0; x < width; x++){
+				const unsigned char* pixel = row + taps.first[x] * Channels;
+				const int* weights = &taps.weights[x * taps.maxTaps];
+				int sums[Channels];
+				for(int c = 0; c < Channels; c++){
+					sums[c] = WEIGHT_ONE/2;
+				}
+				for(int j = 0; j < taps.count[x]; j++){
+					for(int c = 0; c < Channels; c++){
+						sums[c] += weights[j] * pixel[j * Channels + c];
+					}
+				}
+				for(int c = 0; c < Channels; c++){
+					outRow[x * Channels + c] = clampChannel(sums[c]);
+				}
+			}
+		}
+	}
+};
+
+static void resampleHorizontal(const ofPixels& src, ofPixels& dst, int width, ofxImageSequenceFilter filter)
+{
+	dst.allocate(width, src.getHeight(), src.getNumChannels());
+
+	ofxImageSequenceTaps taps;
+	computeTaps(src.getWidth(), width, filter, taps);
+	ofxImageSequenceDispatchChannels<ofxImageSequenceHorizontalKernel>(src.getNumChannels(), src, dst, taps);
+}
+
+static void resampleVertical(const ofPixels& src, ofPixels& dst, int height, ofxImageSequenceFilter filter)
+{
+	int width = src.getWidth();
+	int channels = src.getNumChannels();
+	int rowSize = width * channels;
+	dst.allocate(width, height, channels);
+
+	ofxImageSequenceTaps taps;
+	computeTaps(src.getHeight(), height, filter, taps);
+
+	const unsigned char* in = src.getData();
+	unsigned char* out = dst.getData();
+	vector<int> sums(rowSize);
+	for(int y = 0; y < height; y++){
+		std::fill(sums.begin(), sums.end(), WEIGHT_ONE/2);
+		const int* weights = &taps.weights[y * taps.maxTaps];
+
+		//whole rows at a time, contiguous and branch free so it vectorizes
+		for(int j = 0; j < taps.count[y]; j++){
+			const unsigned char* row = in + (taps.first[y] + j) * rowSize;
+			int weight = weights[j];
+			int* sum = &sums[0];
+			for(int i = 0; i < rowSize; i++){
+				sum[i] += weight * row[i];
+			}
+		}
+
+		unsigned char* outRow = out + y * rowSize;
+		for(int i = 0; i < rowSize; i++){
+			outRow[i] = clampChannel(sums[i]);
+		}
+	}
+}
+
+void ofxImageSequenceResample(const ofPixels& src, ofPixels& dst, int width, int height, ofxImageSequenceFilter filter)
+{
+	if(width <= 0 || height <= 0 || src.getNumChannels() > 4){
+		ofLogError("ofxImageSequenceResample") << "Can't resample to " << width << "x" << height;
+		return;
+	}
+
+	bool horizontal = width != src.getWidth();
+	bool vertical = height != src.getHeight();
+	if(horizontal && vertical){
+		//horizontal first, the vertical pass then runs over the narrower rows
+		ofPixels narrow;
+		resampleHorizontal(src, narrow, width, filter);
+		resampleVertical(narrow, dst, height, filter);
+	}
+	else if(horizontal){
+		resampleHorizontal(src, dst, width, filter);
+	}
+	else if(vertical){
+		resampleVertical(src, dst, height, filter);
+	}
+	else{
+		dst = src;
+	}
+}
+
+//averages 2x2 blocks, an odd trailing row or column is dropped
+template<int Channels>
+struct ofxImageSequenceHalveKernel {
+	static void run(const ofPixels& src, ofPixels& dst){
+		int w = dst.getWidth();
+		int h = dst.getHeight();
+		int stride = src.getWidth() * Channels;
+		const unsigned char* in = src.getData();
+		unsigned char* out = dst.getData();
+		for(int y = 0; y < h; y++){
+			const unsigned char* row0 = in + 2*y*stride;
+			const unsigned char* row1 = row0 + stride;
+			unsigned char* row = out + y*w*Channels;
+			for(int x = 0; x < w; x++){
+				for(int c = 0; c < Channels; c++){
+					int i = 2*x*Channels + c;
+					row[x*Channels + c] = (row0[i] + row0[i + Channels] + row1[i] + row1[i + Channels] + 2) >> 2;
+				}
+			}
+		}
+	}
+};
+
+void ofxImageSequenceHalve(const ofPixels& src, ofPixels& dst)
+{
+	dst.allocate(src.getWidth() / 2, src.getHeight() / 2, src.getNumChannels());
+	ofxImageSequenceDispatchChannels<ofxImageSequenceHalveKernel>(src.getNumChannels(), src, dst);
+}
@@ -0,0 +1,28 @@
+/**
+ *  ofxImageSequenceResample.h
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  Separable resampling used to shrink frames to a target size on the loader threads.
+ *
+ *  Each pass precomputes fixed point weights per output pixel, then filters rows horizontally
+ *  and columns vertically. The vertical pass accumulates whole rows at a time so compilers
+ *  vectorize it (SSE/AVX2 on x86, NEON on ARM) without any platform specific code.
+ */
+
+#pragma once
+
+#include "ofMain.h"
+
+enum ofxImageSequenceFilter {
+	OFX_IMAGE_SEQUENCE_FILTER_BOX = 0,		//area average, fastest and never rings
+	OFX_IMAGE_SEQUENCE_FILTER_LANCZOS		//3 lobe Lanczos, sharpest
+};
+
+//resamples src into dst at width x height, dst is reallocated
+void ofxImageSequenceResample(const ofPixels& src, ofPixels& dst, int width, int height, ofxImageSequenceFilter filter);
+
+//halves width and height with a 2x2 box filter, used for reduced quality levels
+void ofxImageSequenceHalve(const ofPixels& src, ofPixels& dst);
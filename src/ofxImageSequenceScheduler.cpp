@@ -0,0 +1,616 @@
+/**
+ *  ofxImageSequenceScheduler.cpp
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofxImageSequenceScheduler.h"
+
+class ofxImageSequenceSchedulerWorker : public ofThread
+{
+  public:
+
+	ofxImageSequenceScheduler& schedulerRef;
+
+	ofxImageSequenceSchedulerWorker(ofxImageSequenceScheduler* scheduler)
+	: schedulerRef(*scheduler)
+	{
+		startThread(true);
+	}
+
+	void threadedFunction(){
+		while(isThreadRunning() && schedulerRef.runNextJob()){
+		}
+	}
+
+};
+
+//scans first, then decodes, then warming, each earliest deadline first
+bool ofxImageSequenceScheduler::Job::operator<(const Job& other) const
+{
+	if(kind != other.kind) return kind < other.kind;
+	if(neededBy != other.neededBy) return neededBy < other.neededBy;
+	if(priority != other.priority) return priority < other.priority;
+	if(warmup != other.warmup) return warmup < other.warmup;
+	if(cue != other.cue) return cue < other.cue;
+	return frame < other.frame;
+}
+
+ofxImageSequenceScheduler::ofxImageSequenceScheduler()
+{
+	running = false;
+	jobsInFlight = 0;
+	memoryBudget = OFX_IMAGE_SEQUENCE_UNLIMITED;
+	cueBytes = 0;
+	cueLeadTime = -1;
+	for(int i = 0; i < NUM_JOB_KINDS; i++){
+		pendingJobs[i] = 0;
+		finishedJobs[i] = 0;
+		jobMicros[i] = 0;
+	}
+}
+
+ofxImageSequenceScheduler::~ofxImageSequenceScheduler()
+{
+	stop();
+}
+
+void ofxImageSequenceScheduler::addWarmup(ofxImageSequence* sequence, string folder, float neededBy, int priority, int framesToDecode)
+{
+	sequence->unloadSequence();
+	sequence->folderToLoad = folder;
+
+	Warmup warmup;
+	warmup.sequence = sequence;
+	warmup.folder = folder;
+	warmup.neededBy = neededBy;
+	warmup.priority = priority;
+	warmup.framesToDecode = framesToDecode;
+	warmup.framesDecoded = 0;
+	warmup.scanned = false;
+	warmup.failed = false;
+	warmup.completed = false;
+	warmup.ready = false;
+
+	jobMutex.lock();
+	warmups.push_back(warmup);
+	pushJob(JOB_SCAN, warmups.size()-1, 0);
+	jobMutex.unlock();
+	jobAdded.notify_one();
+}
+
+int ofxImageSequenceScheduler::addCue(ofxImageSequence* sequence, int startFrame, int endFrame, float neededBy, float doneBy, int priority)
+{
+	if(sequence->getTotalFrames() == 0){
+		ofLogError("ofxImageSequenceScheduler::addCue") << "Cues need a loaded sequence";
+		return -1;
+	}
+
+	Cue cue;
+	cue.sequence = sequence;
+	cue.startFrame = ofClamp(startFrame, 0, sequence->getTotalFrames()-1);
+	cue.endFrame = ofClamp(endFrame, cue.startFrame, sequence->getTotalFrames()-1);
+	cue.neededBy = neededBy;
+	cue.doneBy = doneBy;
+	cue.priority = priority;
+	cue.framesDecoded = 0;
+	cue.framesReady = 0;
+	cue.ready = false;
+	cue.released = false;
+
+	jobMutex.lock();
+	cues.push_back(cue);
+	int index = cues.size()-1;
+	for(int i = cue.startFrame; i <= cue.endFrame; i++){
+		pushCueJob(index, i);
+	}
+	jobMutex.unlock();
+	jobAdded.notify_all();
+	return index;
+}
+
+void ofxImageSequenceScheduler::releaseCue(int index)
+{
+	vector<int> drop;
+	ofxImageSequence* sequence;
+	{
+		ofScopedLock lock(jobMutex);
+		if(index < 0 || index >= cues.size() || cues[index].released){
+			return;
+		}
+		Cue& cue = cues[index];
+		cue.released = true;
+		sequence = cue.sequence;
+
+		//pending loads of the cue are cancelled
+		for(set<Job>::iterator it = jobs.begin(); it != jobs.end();){
+			if(it->cue == index){
+				pendingJobs[it->kind] = MAX(pendingJobs[it->kind] - 1, 0);
+				jobs.erase(it++);
+			}
+			else{
+				++it;
+			}
+		}
+
+		//frames no other cue holds are let go, and those the cue decoded itself dropped. frames that were
+		//resident before the cue stay, the playing sequence may be using them
+		for(int i = 0; i < cue.held.size(); i++){
+			pair<ofxImageSequence*, int> key = make_pair(sequence, cue.held[i]);
+			if(--frameHolds[key] > 0){
+				continue;
+			}
+			frameHolds.erase(key);
+			sequence->releaseFrame(cue.held[i]);
+			map< pair<ofxImageSequence*, int>, uint64_t >::iterator owned = cueFrames.find(key);
+			if(owned != cueFrames.end()){
+				cueBytes -= MIN(owned->second, cueBytes);
+				cueFrames.erase(owned);
+				drop.push_back(cue.held[i]);
+			}
+		}
+		cue.held.clear();
+	}
+	jobAdded.notify_all();
+
+	//demoting may write the disk cache, which the main thread must not wait for
+	for(int i = 0; i < drop.size(); i++){
+		sequence->queueDemotion(drop[i]);
+	}
+}
+
+bool ofxImageSequenceScheduler::isCueReady(int index)
+{
+	ofScopedLock lock(jobMutex);
+	return index >= 0 && index < cues.size() && cues[index].ready;
+}
+
+int ofxImageSequenceScheduler::getCueFramesDecoded(int index)
+{
+	ofScopedLock lock(jobMutex);
+	return index >= 0 && index < cues.size() ? cues[index].framesDecoded : 0;
+}
+
+void ofxImageSequenceScheduler::setMemoryBudget(uint64_t bytes)
+{
+	jobMutex.lock();
+	memoryBudget = bytes;
+	jobMutex.unlock();
+	jobAdded.notify_all();
+}
+
+uint64_t ofxImageSequenceScheduler::getCueBytes()
+{
+	ofScopedLock lock(jobMutex);
+	pruneCueFrames();
+	return cueBytes;
+}
+
+void ofxImageSequenceScheduler::setCueLeadTime(float seconds)
+{
+	jobMutex.lock();
+	cueLeadTime = seconds;
+	jobMutex.unlock();
+	jobAdded.notify_all();
+}
+
+void ofxImageSequenceScheduler::start(int numThreads)
+{
+	if(running){
+		return;
+	}
+	if(numThreads <= 0){
+		numThreads = MAX((int)std::thread::hardware_concurrency(), 1);
+	}
+
+	running = true;
+	ofAddListener(ofEvents().update, this, &ofxImageSequenceScheduler::update);
+	for(int i = 0; i < numThreads; i++){
+		workers.push_back(shared_ptr<ofxImageSequenceSchedulerWorker>(new ofxImageSequenceSchedulerWorker(this)));
+	}
+}
+
+void ofxImageSequenceScheduler::stop()
+{
+	if(!running){
+		return;
+	}
+	ofRemoveListener(ofEvents().update, this, &ofxImageSequenceScheduler::update);
+
+	jobMutex.lock();
+	running = false;
+	jobs.clear();
+	for(int i = 0; i < NUM_JOB_KINDS; i++){
+		pendingJobs[i] = 0;
+	}
+	jobMutex.unlock();
+	jobAdded.notify_all();
+
+	for(int i = 0; i < workers.size(); i++){
+		workers[i]->waitForThread(true);
+	}
+	workers.clear();
+}
+
+//called with jobMutex locked
+void ofxImageSequenceScheduler::pushJob(JobKind kind, int warmup, int frame)
+{
+	Job job;
+	job.kind = kind;
+	job.neededBy = warmups[warmup].neededBy;
+	job.priority = warmups[warmup].priority;
+	job.warmup = warmup;
+	job.cue = -1;
+	job.frame = frame;
+	jobs.insert(job);
+	pendingJobs[kind]++;
+}
+
+//called with jobMutex locked
+void ofxImageSequenceScheduler::pushCueJob(int cue, int frame)
+{
+	Job job;
+	job.kind = JOB_DECODE;
+	job.neededBy = cues[cue].neededBy;
+	job.priority = cues[cue].priority;
+	job.warmup = -1;
+	job.cue = cue;
+	job.frame = frame;
+	jobs.insert(job);
+	pendingJobs[JOB_DECODE]++;
+}
+
+//called with jobMutex locked. cue jobs wait for their lead time and for room in the memory budget,
+//everything else queued behind them can still run meanwhile
+set<ofxImageSequenceScheduler::Job>::iterator ofxImageSequenceScheduler::findRunnableJob()
+{
+	float now = ofGetElapsedTimef();
+	if(memoryBudget != OFX_IMAGE_SEQUENCE_UNLIMITED){
+		pruneCueFrames();
+	}
+	for(set<Job>::iterator it = jobs.begin(); it != jobs.end(); ++it){
+		if(it->cue == -1){
+			return it;
+		}
+		if(cueLeadTime >= 0 && now < it->neededBy - cueLeadTime){
+			continue;
+		}
+		ofxImageSequence* sequence = cues[it->cue].sequence;
+		if(memoryBudget != OFX_IMAGE_SEQUENCE_UNLIMITED &&
+		   cueBytes + sequence->getTierFrameBytes(OFX_IMAGE_SEQUENCE_TIER_DECODED) > memoryBudget &&
+		   cueFrames.count(make_pair(sequence, it->frame)) == 0 && frameHolds.count(make_pair(sequence, it->frame)) == 0){
+			continue;
+		}
+		return it;
+	}
+	return jobs.end();
+}
+
+//called with jobMutex locked. the frame counts as ready only once it is held in RAM, so the tiers can't
+//demote it before the cue is released
+bool ofxImageSequenceScheduler::holdCueFrame(int cue, int frame)
+{
+	ofxImageSequence* sequence = cues[cue].sequence;
+	if(cues[cue].released || !sequence->holdFrame(frame)){
+		return false;
+	}
+	frameHolds[make_pair(sequence, frame)]++;
+	cues[cue].held.push_back(frame);
+	cues[cue].framesReady++;
+	return true;
+}
+
+//the frame's bytes only count for cues when the cue is what brought it into the decoded tier
+void ofxImageSequenceScheduler::acquireCueFrame(int cue, int frame)
+{
+	jobMutex.lock();
+	ofxImageSequence* sequence = cues[cue].sequence;
+	bool done = cues[cue].released || holdCueFrame(cue, frame);
+	jobMutex.unlock();
+
+	if(done){
+		return;
+	}
+
+	shared_ptr<const ofPixels> pixels = sequence->acquirePixels(frame, true);
+
+	sequence->frameMutex.lock();
+	bool stored = pixels && sequence->sequence[frame] == pixels;
+	uint64_t bytes = stored ? sequence->getDecodedBytes(frame) : 0;	//with the linear copy
+	bool failed = sequence->isFrameFailed(frame);
+	sequence->frameMutex.unlock();
+
+	jobMutex.lock();
+	pair<ofxImageSequence*, int> key = make_pair(sequence, frame);
+	bool releasedMeanwhile = cues[cue].released;
+	bool held = holdCueFrame(cue, frame);
+	if(held && stored && cueFrames.count(key) == 0){
+		cueFrames[key] = bytes;
+		cueBytes += bytes;
+		cues[cue].framesDecoded++;
+	}
+	//a frame decoded but not kept, because the decoded tier is full, is not ready
+	if(!held && failed){
+		cues[cue].framesReady++;
+	}
+	bool drop = stored && releasedMeanwhile && frameHolds.count(key) == 0;
+	jobMutex.unlock();
+
+	if(drop){
+		sequence->demoteFrame(frame, OFX_IMAGE_SEQUENCE_TIER_DECODED);
+	}
+}
+
+//called with jobMutex locked. held frames only leave the decoded tier when their sequence is unloaded
+//or swapped, and then their bytes no longer count against the budget
+void ofxImageSequenceScheduler::pruneCueFrames()
+{
+	for(map< pair<ofxImageSequence*, int>, uint64_t >::iterator it = cueFrames.begin(); it != cueFrames.end();){
+		ofxImageSequence* sequence = it->first.first;
+		int frame = it->first.second;
+		sequence->frameMutex.lock();
+		bool inRam = frame < sequence->sequence.size() && sequence->sequence[frame] != NULL;
+		sequence->frameMutex.unlock();
+		if(inRam){
+			++it;
+			continue;
+		}
+		cueBytes -= MIN(it->second, cueBytes);
+		cueFrames.erase(it++);
+	}
+}
+
+bool ofxImageSequenceScheduler::runNextJob()
+{
+	Job job;
+	ofxImageSequence* sequence;
+	{
+		std::unique_lock<std::mutex> lck(jobMutex);
+		set<Job>::iterator next;
+		while(running && (next = findRunnableJob()) == jobs.end()){
+			//cue jobs become runnable as time passes, so don't wait for a notification forever
+			jobAdded.wait_for(lck, std::chrono::milliseconds(100));
+		}
+		if(!running){
+			return false;
+		}
+		job = *next;
+		jobs.erase(next);
+		jobsInFlight++;
+		sequence = job.cue == -1 ? warmups[job.warmup].sequence : cues[job.cue].sequence;
+	}
+
+	uint64_t startMicros = ofGetElapsedTimeMicros();
+	bool kept = true;
+
+	if(job.kind == JOB_SCAN){
+		bool scanned = sequence->preloadAllFilenames();
+
+		jobMutex.lock();
+		Warmup& warmup = warmups[job.warmup];
+		if(scanned){
+			int total = sequence->getTotalFrames();
+			warmup.framesToDecode = warmup.framesToDecode < 0 ? total : MIN(warmup.framesToDecode, total);
+			warmup.scanned = true;
+			for(int i = 0; i < total; i++){
+				pushJob(i < warmup.framesToDecode ? JOB_DECODE : JOB_WARM, job.warmup, i);
+			}
+		}
+		else{
+			warmup.failed = true;
+			ofLogError("ofxImageSequenceScheduler::runNextJob") << "Could not scan " << warmup.folder;
+		}
+		jobMutex.unlock();
+		jobAdded.notify_all();
+	}
+	else if(job.cue != -1){
+		acquireCueFrame(job.cue, job.frame);
+	}
+	else{
+		kept = false;
+		sequence->frameMutex.lock();
+		bool decode = job.kind == JOB_DECODE &&
+					  sequence->hasTierRoom(OFX_IMAGE_SEQUENCE_TIER_DECODED, sequence->getTierFrameBytes(OFX_IMAGE_SEQUENCE_TIER_DECODED));
+		bool keepCompressed = !decode &&
+					  sequence->isTierBounded(OFX_IMAGE_SEQUENCE_TIER_COMPRESSED) &&
+					  sequence->hasTierRoom(OFX_IMAGE_SEQUENCE_TIER_COMPRESSED, sequence->getTierFrameBytes(OFX_IMAGE_SEQUENCE_TIER_COMPRESSED));
+		sequence->frameMutex.unlock();
+
+		if(decode){
+			sequence->acquirePixels(job.frame, true);
+			//the tier may have filled up meanwhile, and then the frame was decoded but not kept
+			sequence->frameMutex.lock();
+			kept = sequence->sequence[job.frame] != NULL || sequence->isFrameFailed(job.frame);
+			sequence->frameMutex.unlock();
+		}
+		else if(keepCompressed){
+			sequence->promoteFrame(job.frame, OFX_IMAGE_SEQUENCE_TIER_COMPRESSED);
+		}
+		else{
+			//read once and drop, the OS keeps it in the page cache
+			ofBufferFromFile(sequence->filenames[job.frame], true);
+		}
+	}
+
+	finishJob(job, ofGetElapsedTimeMicros() - startMicros, kept);
+	return true;
+}
+
+//kept is false for warmup decodes the decoded tier had no room for
+void ofxImageSequenceScheduler::finishJob(const Job& job, uint64_t micros, bool kept)
+{
+	ofScopedLock lock(jobMutex);
+	jobsInFlight--;
+	pendingJobs[job.kind] = MAX(pendingJobs[job.kind] - 1, 0);
+	finishedJobs[job.kind]++;
+	jobMicros[job.kind] += micros;
+	if(job.kind == JOB_DECODE && job.cue != -1){
+		Cue& cue = cues[job.cue];
+		if(!cue.ready && !cue.released && cue.framesReady > cue.endFrame - cue.startFrame){
+			cue.ready = true;
+			if(ofGetElapsedTimef() > cue.neededBy){
+				ofLogWarning("ofxImageSequenceScheduler") << "Cue " << job.cue << " was ready " << (ofGetElapsedTimef() - cue.neededBy) << "s late";
+			}
+		}
+	}
+	else if(job.kind == JOB_DECODE){
+		//a warmup asking for more than the budget holds is ready once everything that fits is in RAM
+		Warmup& warmup = warmups[job.warmup];
+		if(kept){
+			warmup.framesDecoded++;
+		}
+		else{
+			warmup.framesToDecode = MAX(warmup.framesToDecode - 1, 0);
+		}
+		checkReady(job.warmup);
+	}
+}
+
+//called with jobMutex locked
+void ofxImageSequenceScheduler::checkReady(int index)
+{
+	Warmup& warmup = warmups[index];
+	if(warmup.ready || !warmup.completed || warmup.framesDecoded < warmup.framesToDecode){
+		return;
+	}
+	warmup.ready = true;
+
+	float now = ofGetElapsedTimef();
+	if(now > warmup.neededBy){
+		ofLogWarning("ofxImageSequenceScheduler") << warmup.folder << " was ready " << (now - warmup.neededBy) << "s late";
+	}
+	else{
+		ofLogVerbose("ofxImageSequenceScheduler") << warmup.folder << " ready " << (warmup.neededBy - now) << "s ahead";
+	}
+}
+
+//loading completes on the main thread since it uploads the first frame
+void ofxImageSequenceScheduler::update(ofEventArgs& args)
+{
+	vector<int> scanned;
+	jobMutex.lock();
+	for(int i = 0; i < warmups.size(); i++){
+		if(warmups[i].scanned && !warmups[i].completed){
+			scanned.push_back(i);
+		}
+	}
+	jobMutex.unlock();
+
+	for(int i = 0; i < scanned.size(); i++){
+		warmups[scanned[i]].sequence->completeLoading();
+
+		jobMutex.lock();
+		warmups[scanned[i]].completed = true;
+		checkReady(scanned[i]);
+		jobMutex.unlock();
+	}
+
+	vector<int> done;
+	float now = ofGetElapsedTimef();
+	jobMutex.lock();
+	for(int i = 0; i < cues.size(); i++){
+		if(!cues[i].released && cues[i].doneBy >= 0 && now > cues[i].doneBy){
+			done.push_back(i);
+		}
+	}
+	jobMutex.unlock();
+
+	for(int i = 0; i < done.size(); i++){
+		releaseCue(done[i]);
+	}
+}
+
+bool ofxImageSequenceScheduler::isReady(ofxImageSequence* sequence)
+{
+	ofScopedLock lock(jobMutex);
+	for(int i = 0; i < warmups.size(); i++){
+		if(warmups[i].sequence == sequence){
+			return warmups[i].ready;
+		}
+	}
+	return false;
+}
+
+bool ofxImageSequenceScheduler::isWarm()
+{
+	ofScopedLock lock(jobMutex);
+	if(!jobs.empty() || jobsInFlight > 0){
+		return false;
+	}
+	for(int i = 0; i < warmups.size(); i++){
+		if(!warmups[i].completed && !warmups[i].failed){
+			return false;
+		}
+	}
+	return true;
+}
+
+float ofxImageSequenceScheduler::getProgress()
+{
+	ofScopedLock lock(jobMutex);
+	int finished = 0;
+	int pending = 0;
+	for(int i = 0; i < NUM_JOB_KINDS; i++){
+		finished += finishedJobs[i];
+		pending += pendingJobs[i];
+	}
+	if(finished + pending == 0){
+		return 0.0;
+	}
+	return 1.0*finished / (finished + pending);
+}
+
+float ofxImageSequenceScheduler::getEstimatedSecondsRemaining()
+{
+	ofScopedLock lock(jobMutex);
+	double micros = 0;
+	for(int i = 0; i < NUM_JOB_KINDS; i++){
+		if(pendingJobs[i] == 0){
+			continue;
+		}
+		if(finishedJobs[i] == 0){
+			return -1;
+		}
+		micros += pendingJobs[i] * (double(jobMicros[i]) / finishedJobs[i]);
+	}
+	return micros / MAX((int)workers.size(), 1) / 1000000.0;
+}
+
+float ofxImageSequenceScheduler::getEstimatedSecondsUntilReady(ofxImageSequence* sequence)
+{
+	ofScopedLock lock(jobMutex);
+	int index = -1;
+	for(int i = 0; i < warmups.size(); i++){
+		if(warmups[i].sequence == sequence){
+			index = i;
+		}
+	}
+	if(index == -1 || warmups[index].failed){
+		return -1;
+	}
+	if(warmups[index].ready){
+		return 0;
+	}
+	if(!warmups[index].scanned || finishedJobs[JOB_SCAN] == 0 || finishedJobs[JOB_DECODE] == 0){
+		return -1;
+	}
+
+	//everything queued ahead of this sequence's last decode
+	Job last;
+	last.kind = JOB_DECODE;
+	last.neededBy = warmups[index].neededBy;
+	last.priority = warmups[index].priority;
+	last.warmup = index;
+	last.cue = -1;
+	last.frame = warmups[index].framesToDecode;
+	int decodesAhead = 0;
+	for(set<Job>::iterator it = jobs.begin(); it != jobs.end() && *it < last; ++it){
+		if(it->kind == JOB_DECODE){
+			decodesAhead++;
+		}
+	}
+
+	double micros = pendingJobs[JOB_SCAN] * (double(jobMicros[JOB_SCAN]) / finishedJobs[JOB_SCAN]) +
+					decodesAhead * (double(jobMicros[JOB_DECODE]) / finishedJobs[JOB_DECODE]);
+	return micros / MAX((int)workers.size(), 1) / 1000000.0;
+}
@@ -0,0 +1,147 @@
+/**
+ *  ofxImageSequenceScheduler.h
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  ofxImageSequenceScheduler warms up many sequences at once from a shared pool of worker threads.
+ *
+ *  Each sequence is queued with the time it is needed by (in ofGetElapsedTimef() seconds) and a priority.
+ *  All directory scans run first, since they are cheap and tell how much work is left, then the frames
+ *  to decode are worked through earliest deadline first, and finally the remaining frames are read once
+ *  to warm the OS page cache (or the compressed tier when it has a budget). So the content of the first
+ *  cue is always the first to be ready, and getEstimatedSecondsRemaining gives a global ETA.
+ *
+ *	scheduler.addWarmup(&intro, "intro", ofGetElapsedTimef() + 30, 0, 60);
+ *	scheduler.addWarmup(&act1, "act1", ofGetElapsedTimef() + 120);
+ *	scheduler.start();
+ *
+ *  During the show, cues declare upcoming needs of already loaded sequences: a frame range and the time
+ *  it is needed by. Cue frames are decoded just in time, no earlier than the lead time before their
+ *  deadline and only while the frames held for cues fit the memory budget, and are dropped again once
+ *  the cue is released, so transitions never hit a cold sequence and nothing is preloaded all at once.
+ *  Until then a cue holds its frames in the decoded tier, outside the playhead window and the eviction
+ *  policy, so they still take room in the tier's budget.
+ *
+ *	int cue = scheduler.addCue(&act2, 0, 90, showTime + 12, showTime + 40);
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxImageSequence.h"
+
+class ofxImageSequenceSchedulerWorker;
+class ofxImageSequenceScheduler {
+  public:
+
+	ofxImageSequenceScheduler();
+	~ofxImageSequenceScheduler();
+
+	/**
+	 *	Queues a sequence to load from folder. It is unloaded right away and scanned from the pool.
+	 *	framesToDecode frames from the start are decoded into RAM, -1 decodes as many as the decoded tier
+	 *	budget allows, and the rest are only warmed. Lower priority values win between equal deadlines.
+	 *	Call from the main thread, before or after start.
+	 */
+	void addWarmup(ofxImageSequence* sequence, string folder, float neededBy, int priority = 0, int framesToDecode = -1);
+
+	/**
+	 *	Declares that frames startFrame to endFrame (inclusive) of a loaded sequence are needed by neededBy.
+	 *	The frames are released automatically after doneBy, or never if it is negative. Returns the cue id.
+	 */
+	int addCue(ofxImageSequence* sequence, int startFrame, int endFrame, float neededBy, float doneBy = -1, int priority = 0);
+	void releaseCue(int cue);					//drops the frames the cue decoded that no other active cue needs
+	bool isCueReady(int cue);					//every frame of the cue is in RAM, or failed
+	int getCueFramesDecoded(int cue);			//frames the cue had to decode, not counting those already resident
+	void setMemoryBudget(uint64_t bytes);		//bytes held for cues, unlimited by default
+	uint64_t getCueBytes();
+	void setCueLeadTime(float seconds);			//how long before its deadline a cue may start loading, unlimited by default
+
+	void start(int numThreads = 0);		//0 uses one thread per core
+	void stop();						//cancels the remaining work
+
+	bool isReady(ofxImageSequence* sequence);	//scanned, loaded and its frames to decode are in RAM
+	bool isWarm();								//all the queued work is done
+	float getProgress();						//0.0 - 1.0 of the known work
+	float getEstimatedSecondsRemaining();		//global ETA, -1 until enough work was timed to tell
+	float getEstimatedSecondsUntilReady(ofxImageSequence* sequence);
+
+	//Do not call directly
+	//called from the worker threads
+	bool runNextJob();
+
+  protected:
+
+	enum JobKind {
+		JOB_SCAN = 0,
+		JOB_DECODE,
+		JOB_WARM,
+		NUM_JOB_KINDS
+	};
+
+	struct Job {
+		JobKind kind;
+		float neededBy;
+		int priority;
+		int warmup;		//-1 for cue jobs
+		int cue;		//-1 for warmup jobs
+		int frame;
+		bool operator<(const Job& other) const;
+	};
+
+	struct Warmup {
+		ofxImageSequence* sequence;
+		string folder;
+		float neededBy;
+		int priority;
+		int framesToDecode;
+		int framesDecoded;
+		bool scanned;
+		bool failed;
+		bool completed;		//completeLoading ran on the main thread
+		bool ready;
+	};
+
+	struct Cue {
+		ofxImageSequence* sequence;
+		int startFrame;
+		int endFrame;
+		float neededBy;
+		float doneBy;
+		int priority;
+		int framesDecoded;	//by the cue itself
+		int framesReady;	//held in RAM or failed, decoded by the cue or already resident
+		vector<int> held;	//frames the cue holds in the decoded tier
+		bool ready;
+		bool released;
+	};
+
+	void update(ofEventArgs& args);
+	void pushJob(JobKind kind, int warmup, int frame);
+	void pushCueJob(int cue, int frame);
+	set<Job>::iterator findRunnableJob();
+	void acquireCueFrame(int cue, int frame);
+	bool holdCueFrame(int cue, int frame);
+	void pruneCueFrames();
+	void finishJob(const Job& job, uint64_t micros, bool kept);
+	void checkReady(int warmup);
+
+	ofMutex jobMutex;
+	std::condition_variable jobAdded;
+	set<Job> jobs;
+	vector<Warmup> warmups;
+	vector<Cue> cues;
+	map< pair<ofxImageSequence*, int>, uint64_t > cueFrames;	//bytes of the frames cues decoded themselves, resident ones are never taken over
+	map< pair<ofxImageSequence*, int>, int > frameHolds;		//cues holding each frame
+	uint64_t memoryBudget;
+	uint64_t cueBytes;
+	float cueLeadTime;
+	vector< shared_ptr<ofxImageSequenceSchedulerWorker> > workers;
+	int jobsInFlight;
+	int pendingJobs[NUM_JOB_KINDS];
+	int finishedJobs[NUM_JOB_KINDS];
+	uint64_t jobMicros[NUM_JOB_KINDS];
+	bool running;
+};
@@ -0,0 +1,384 @@
+/**
+ *  ofxImageSequenceSharedCache.cpp
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofxImageSequenceSharedCache.h"
+
+#ifndef TARGET_WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#endif
+
+static const uint32_t SEGMENT_MAGIC = 0x6f785332;	//"oxS2"
+static const uint64_t ALIGNMENT = 64;
+
+//claims hold the owner's pid in the low bits and steady clock milliseconds above, in one word so they
+//are taken over with a single compare and swap. The top bit is set while the owner publishes
+static const uint64_t CLAIM_PID_BITS = 24;
+static const uint64_t CLAIM_PID_MASK = (1ull << CLAIM_PID_BITS) - 1;
+static const uint64_t CLAIM_PUBLISHING = 1ull << 63;
+static const uint64_t STALE_CLAIM_MILLIS = 10000;	//far longer than any decode
+
+static uint64_t alignUp(uint64_t bytes, uint64_t alignment = ALIGNMENT)
+{
+	return (bytes + alignment - 1) & ~(alignment - 1);
+}
+
+static uint64_t getClaimMillis()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifndef TARGET_WIN32
+static uint64_t makeClaim()
+{
+	return ((getClaimMillis() << CLAIM_PID_BITS) | ((uint64_t)getpid() & CLAIM_PID_MASK)) & ~CLAIM_PUBLISHING;
+}
+
+static bool isClaimOwnerAlive(uint64_t claim)
+{
+	pid_t pid = claim & CLAIM_PID_MASK;
+	return kill(pid, 0) == 0 || errno == EPERM;
+}
+#endif
+
+//lives at the start of the segment, zero filled on creation
+struct ofxImageSequenceSharedHeader {
+	std::atomic<uint32_t> magic;	//set last by the creating process
+	uint32_t numEntries;
+	uint64_t dataOffset;
+	uint64_t dataBytes;
+	std::atomic<uint64_t> dataUsed;
+	std::atomic<uint32_t> numFrames;
+};
+
+enum {
+	ENTRY_WRITING = 0,
+	ENTRY_READY,
+	ENTRY_FAILED,
+	ENTRY_NO_ROOM
+};
+
+struct ofxImageSequenceSharedCache::Entry {
+	std::atomic<uint64_t> key;		//0 while free, claimed with a compare and swap
+	std::atomic<uint32_t> state;
+	std::atomic<uint64_t> claim;	//owner and time of the claim while writing, 0 until the owner stamps it
+	uint32_t width;
+	uint32_t height;
+	uint32_t channels;
+	uint64_t offset;
+};
+
+//one mapping of the segment, kept alive by the pixels handed out. Only the header and index are
+//writable, frame data is written through fd by the process that claimed it
+struct ofxImageSequenceSharedCache::Segment {
+	void* base;
+	uint64_t size;
+	int fd;
+	ofxImageSequenceSharedHeader* header;
+	Entry* entries;
+	const unsigned char* data;
+
+	~Segment(){
+		#ifndef TARGET_WIN32
+		munmap(base, size);
+		::close(fd);
+		#endif
+	}
+};
+
+ofxImageSequenceSharedCache::ofxImageSequenceSharedCache()
+{
+}
+
+ofxImageSequenceSharedCache::~ofxImageSequenceSharedCache()
+{
+	close();
+}
+
+bool ofxImageSequenceSharedCache::open(string name, uint64_t bytes, int maxFrames, int mode)
+{
+	close();
+
+	#ifdef TARGET_WIN32
+	ofLogError("ofxImageSequenceSharedCache::open") << "Shared caches need POSIX shared memory, not available on Windows";
+	return false;
+	#else
+	string path = "/" + name;
+	bool created = true;
+	int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, mode);
+	if(fd == -1 && errno == EEXIST){
+		created = false;
+		fd = shm_open(path.c_str(), O_RDWR, mode);
+	}
+	if(fd == -1){
+		ofLogError("ofxImageSequenceSharedCache::open") << "Could not open shared memory " << path << ": " << strerror(errno);
+		return false;
+	}
+	//the umask may have narrowed the mode, a group sharing the cache needs it exactly
+	if(created && fchmod(fd, mode) == -1){
+		ofLogWarning("ofxImageSequenceSharedCache::open") << "Could not set the mode of " << path << ": " << strerror(errno);
+	}
+
+	uint32_t numEntries = MAX(maxFrames, 1) * 2;	//half full at most keeps probes short
+	uint64_t pageSize = sysconf(_SC_PAGESIZE);
+	uint64_t dataOffset = alignUp(sizeof(ofxImageSequenceSharedHeader) + numEntries * sizeof(Entry), pageSize);
+	uint64_t size = dataOffset + bytes;
+	if(created){
+		if(ftruncate(fd, size) == -1){
+			ofLogError("ofxImageSequenceSharedCache::open") << "Could not allocate " << size << " bytes of shared memory: " << strerror(errno);
+			::close(fd);
+			shm_unlink(path.c_str());
+			return false;
+		}
+	}
+	else{
+		//the creating process may not have sized it yet
+		struct stat info;
+		for(int i = 0; i < 1000 && fstat(fd, &info) == 0 && info.st_size == 0; i++){
+			ofSleepMillis(1);
+		}
+		size = fstat(fd, &info) == 0 ? info.st_size : 0;
+	}
+
+	//read only, the header and index are made writable once their size is known
+	void* base = size > 0 ? mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+	if(base == MAP_FAILED){
+		ofLogError("ofxImageSequenceSharedCache::open") << "Could not map shared memory " << path;
+		::close(fd);
+		if(created){
+			shm_unlink(path.c_str());
+		}
+		return false;
+	}
+
+	shared_ptr<Segment> mapped(new Segment());
+	mapped->base = base;
+	mapped->size = size;
+	mapped->fd = fd;
+	mapped->header = (ofxImageSequenceSharedHeader*)base;
+
+	ofxImageSequenceSharedHeader* header = mapped->header;
+	if(created){
+		//never initialised, so peers must not find it
+		if(mprotect(base, dataOffset, PROT_READ | PROT_WRITE) == -1){
+			ofLogError("ofxImageSequenceSharedCache::open") << "Could not map the index of " << path << ": " << strerror(errno);
+			shm_unlink(path.c_str());
+			return false;
+		}
+		header->numEntries = numEntries;
+		header->dataOffset = dataOffset;
+		header->dataBytes = bytes;
+		header->magic.store(SEGMENT_MAGIC, std::memory_order_release);
+	}
+	else{
+		for(int i = 0; i < 1000 && header->magic.load(std::memory_order_acquire) != SEGMENT_MAGIC; i++){
+			ofSleepMillis(1);
+		}
+		if(header->magic.load(std::memory_order_acquire) != SEGMENT_MAGIC){
+			ofLogError("ofxImageSequenceSharedCache::open") << path << " is not an ofxImageSequence cache";
+			return false;
+		}
+		if(header->dataOffset % pageSize != 0 || header->dataOffset > size ||
+		   mprotect(base, header->dataOffset, PROT_READ | PROT_WRITE) == -1){
+			ofLogError("ofxImageSequenceSharedCache::open") << "Could not map the index of " << path;
+			return false;
+		}
+	}
+
+	mapped->entries = (Entry*)((unsigned char*)base + sizeof(ofxImageSequenceSharedHeader));
+	mapped->data = (unsigned char*)base + header->dataOffset;
+	segment = mapped;
+	return true;
+	#endif
+}
+
+void ofxImageSequenceSharedCache::close()
+{
+	segment.reset();
+}
+
+bool ofxImageSequenceSharedCache::isOpen()
+{
+	return segment != NULL;
+}
+
+bool ofxImageSequenceSharedCache::remove(string name)
+{
+	#ifdef TARGET_WIN32
+	return false;
+	#else
+	return shm_unlink(("/" + name).c_str()) == 0;
+	#endif
+}
+
+uint64_t ofxImageSequenceSharedCache::getFileKey(string path)
+{
+	#ifdef TARGET_WIN32
+	return 0;
+	#else
+	struct stat info;
+	if(stat(ofToDataPath(path).c_str(), &info) != 0){
+		return 0;
+	}
+	//FNV-1a over the fields identifying the file
+	uint64_t fields[4] = { (uint64_t)info.st_dev, (uint64_t)info.st_ino, (uint64_t)info.st_size, (uint64_t)info.st_mtime };
+	uint64_t key = 14695981039346656037ull;
+	const unsigned char* bytes = (const unsigned char*)fields;
+	for(int i = 0; i < sizeof(fields); i++){
+		key = (key ^ bytes[i]) * 1099511628211ull;
+	}
+	return key;
+	#endif
+}
+
+shared_ptr<const ofPixels> ofxImageSequenceSharedCache::get(uint64_t key, function<bool(ofPixels&)> decode)
+{
+	shared_ptr<ofPixels> pixels(new ofPixels());
+	#ifdef TARGET_WIN32
+	return decode(*pixels) ? pixels : shared_ptr<ofPixels>();
+	#else
+	if(!segment){
+		return decode(*pixels) ? pixels : shared_ptr<ofPixels>();
+	}
+
+	key = MAX(key, 1);
+	ofxImageSequenceSharedHeader* header = segment->header;
+	Entry* found = NULL;
+	bool claimed = false;
+	for(uint32_t probe = 0; probe < header->numEntries && found == NULL; probe++){
+		Entry& entry = segment->entries[(key + probe) % header->numEntries];
+		uint64_t current = entry.key.load(std::memory_order_acquire);
+		if(current == 0){
+			claimed = entry.key.compare_exchange_strong(current, key);
+		}
+		if(claimed || current == key){
+			found = &entry;
+		}
+	}
+
+	uint64_t claim = 0;
+	if(claimed){
+		claim = makeClaim();
+		found->claim.store(claim, std::memory_order_release);
+	}
+	else if(found != NULL){
+		//another process owns the frame, wait for it to be published or take it over if the owner is gone
+		uint64_t waitStart = getClaimMillis();
+		while(true){
+			uint32_t state = found->state.load(std::memory_order_acquire);
+			if(state == ENTRY_READY){
+				return wrap(*found);
+			}
+			if(state == ENTRY_FAILED){
+				return shared_ptr<ofPixels>();
+			}
+			if(state == ENTRY_NO_ROOM){
+				break;
+			}
+
+			uint64_t current = found->claim.load(std::memory_order_acquire);
+			uint64_t now = getClaimMillis();
+			if(current & CLAIM_PUBLISHING){
+				//died between claiming the publish and finishing it, nobody can safely finish it now
+				if(!isClaimOwnerAlive(current)){
+					found->state.store(ENTRY_NO_ROOM, std::memory_order_release);
+					break;
+				}
+			}
+			else{
+				//an owner that died before stamping its claim is only noticed by the time waited
+				bool dead = current != 0 && !isClaimOwnerAlive(current);
+				uint64_t since = current != 0 ? current >> CLAIM_PID_BITS : waitStart;
+				if(dead || now - since > STALE_CLAIM_MILLIS){
+					uint64_t takeover = makeClaim();
+					if(found->claim.compare_exchange_strong(current, takeover)){
+						ofLogWarning("ofxImageSequenceSharedCache::get") << "Taking over a frame claimed by process "
+							<< (current & CLAIM_PID_MASK) << (dead ? ", which has exited" : ", which stopped responding");
+						claim = takeover;
+						claimed = true;
+						break;
+					}
+				}
+			}
+			ofSleepMillis(1);
+		}
+	}
+
+	bool decoded = decode(*pixels);
+	//only the current owner may publish, a process whose claim was taken over keeps its pixels private
+	if(claimed && !found->claim.compare_exchange_strong(claim, claim | CLAIM_PUBLISHING)){
+		claimed = false;
+	}
+	if(!decoded){
+		if(claimed){
+			found->state.store(ENTRY_FAILED, std::memory_order_release);
+		}
+		return shared_ptr<ofPixels>();
+	}
+	if(!claimed){
+		return pixels;
+	}
+
+	uint64_t offset = header->dataUsed.fetch_add(alignUp(pixels->size()));
+	if(offset + pixels->size() > header->dataBytes || !writeData(offset, *pixels)){
+		found->state.store(ENTRY_NO_ROOM, std::memory_order_release);
+		return pixels;
+	}
+	found->width = pixels->getWidth();
+	found->height = pixels->getHeight();
+	found->channels = pixels->getNumChannels();
+	found->offset = offset;
+	found->state.store(ENTRY_READY, std::memory_order_release);
+	header->numFrames++;
+	return wrap(*found);
+	#endif
+}
+
+//the data area is mapped read only, so frames are written through the descriptor of the segment
+bool ofxImageSequenceSharedCache::writeData(uint64_t offset, const ofPixels& pixels)
+{
+	#ifdef TARGET_WIN32
+	return false;
+	#else
+	const unsigned char* data = pixels.getData();
+	uint64_t written = 0;
+	while(written < pixels.size()){
+		ssize_t result = pwrite(segment->fd, data + written, pixels.size() - written, segment->header->dataOffset + offset + written);
+		if(result == -1 && errno == EINTR){
+			continue;
+		}
+		if(result <= 0){
+			ofLogError("ofxImageSequenceSharedCache::writeData") << "Could not write a frame to shared memory: " << strerror(errno);
+			return false;
+		}
+		written += result;
+	}
+	return true;
+	#endif
+}
+
+//points into the read only segment without copying, the mapping stays alive as long as the pixels
+shared_ptr<const ofPixels> ofxImageSequenceSharedCache::wrap(Entry& entry)
+{
+	shared_ptr<Segment> mapped = segment;
+	ofPixels* pixels = new ofPixels();
+	pixels->setFromExternalPixels(const_cast<unsigned char*>(mapped->data + entry.offset), entry.width, entry.height, entry.channels);
+	return shared_ptr<const ofPixels>(pixels, [mapped](const ofPixels* p){ delete p; });
+}
+
+uint64_t ofxImageSequenceSharedCache::getBytesUsed()
+{
+	return segment ? MIN(segment->header->dataUsed.load(), segment->header->dataBytes) : 0;
+}
+
+int ofxImageSequenceSharedCache::getNumFrames()
+{
+	return segment ? segment->header->numFrames.load() : 0;
+}
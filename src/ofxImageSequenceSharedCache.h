@@ -0,0 +1,67 @@
+/**
+ *  ofxImageSequenceSharedCache.h
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  ofxImageSequenceSharedCache shares decoded frames between processes on the same machine, for setups
+ *  running one player per output on the same content.
+ *
+ *  Every process opens the same named POSIX shared memory segment. Frames are keyed by the identity of
+ *  their source file (device, inode, size and modification time) and the load settings that change the
+ *  pixels. The first process to need a frame claims its key, decodes it and publishes it, the others map
+ *  the published pixels directly, without decoding or copying. The index is a lock-free open addressing
+ *  table: keys are claimed with a compare and swap, and frames are never moved or evicted, so mapped
+ *  pixels stay valid for the life of the segment. Once the segment is full, frames are decoded privately.
+ *  Size it for the content shared.
+ *
+ *	cache.open("show", 8*1024*1024*1024ull, 4000);
+ *	sequence.setSharedCache(&cache);
+ *
+ *  Frame data is mapped read only, the claiming process writes a frame once through the file descriptor
+ *  and it is never written again, so the pixels handed out are const. A claim records the pid of its
+ *  process and when it was made, and is taken over by a waiting process once its owner has died or has
+ *  held it for longer than a decode could take, so a crashed player can't stall the others.
+ *
+ *  Sequences with a frame processor decode privately, since processors can't be told apart by key.
+ *  Not available on Windows. On older Linux systems link with -lrt for shm_open.
+ */
+
+#pragma once
+
+#include "ofMain.h"
+
+class ofxImageSequenceSharedCache {
+  public:
+
+	ofxImageSequenceSharedCache();
+	~ofxImageSequenceSharedCache();
+
+	//creates the segment, or attaches to it if another process already did, in which case its size is used.
+	//mode is the permission of a new segment, only the owner by default, 0660 to share it with a group
+	bool open(string name, uint64_t bytes, int maxFrames, int mode = 0600);
+	void close();						//pixels already handed out stay valid until released
+	bool isOpen();
+	static bool remove(string name);	//unlinks the segment, processes attached keep their mapping
+	static uint64_t getFileKey(string path);	//identifies a file by device, inode, size and modification time, 0 if it can't be read
+
+	/**
+	 *	Returns the published pixels for key, waiting for another process that is decoding them, or
+	 *	claims the key, calls decode and publishes the result. Returns an empty pointer if decode fails.
+	 *	Safe to call from any thread.
+	 */
+	shared_ptr<const ofPixels> get(uint64_t key, function<bool(ofPixels&)> decode);
+
+	uint64_t getBytesUsed();
+	int getNumFrames();
+
+	struct Segment;
+	struct Entry;
+
+  protected:
+	bool writeData(uint64_t offset, const ofPixels& pixels);
+	shared_ptr<const ofPixels> wrap(Entry& entry);
+
+	shared_ptr<Segment> segment;
+};
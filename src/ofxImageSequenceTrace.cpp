@@ -0,0 +1,218 @@
+/**
+ *  ofxImageSequenceTrace.cpp
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ */
+
+#include "ofxImageSequenceTrace.h"
+
+static const char TRACE_MAGIC[8] = { 'O', 'F', 'X', 'I', 'S', 'T', 'R', '1' };
+static const size_t FLUSH_BYTES = 64 * 1024;
+
+//frame deltas are small and either sign, zigzag keeps them to one byte
+static inline uint64_t zigzag(int64_t value)
+{
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t value)
+{
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+ofxImageSequenceTrace::ofxImageSequenceTrace()
+{
+	startMicros = 0;
+	lastMicros = 0;
+}
+
+ofxImageSequenceTrace::~ofxImageSequenceTrace()
+{
+	stopRecording();
+}
+
+bool ofxImageSequenceTrace::startRecording(string path)
+{
+	stopRecording();
+
+	ofScopedLock lock(mutex);
+	file.open(ofToDataPath(path).c_str(), ios::binary | ios::trunc);
+	if(!file){
+		ofLogError("ofxImageSequenceTrace::startRecording") << "Could not open " << path;
+		return false;
+	}
+	file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+	startMicros = ofGetElapsedTimeMicros();
+	lastMicros = 0;
+	lastFrames.clear();
+	sequences.clear();
+	return true;
+}
+
+void ofxImageSequenceTrace::stopRecording()
+{
+	ofScopedLock lock(mutex);
+	if(file.is_open()){
+		flush();
+		file.close();
+	}
+}
+
+bool ofxImageSequenceTrace::isRecording()
+{
+	ofScopedLock lock(mutex);
+	return file.is_open();
+}
+
+//called with mutex locked. the time delta and record type share the first varint
+void ofxImageSequenceTrace::writeHeader(RecordType type)
+{
+	uint64_t micros = ofGetElapsedTimeMicros() - startMicros;
+	writeVarint((micros - lastMicros) << 2 | type);
+	lastMicros = micros;
+}
+
+//called with mutex locked
+void ofxImageSequenceTrace::writeVarint(uint64_t value)
+{
+	while(value >= 0x80){
+		buffer.push_back((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	buffer.push_back((unsigned char)value);
+}
+
+//called with mutex locked
+void ofxImageSequenceTrace::flush()
+{
+	if(!buffer.empty()){
+		file.write((const char*)&buffer[0], buffer.size());
+		buffer.clear();
+	}
+}
+
+void ofxImageSequenceTrace::recordRequest(int sequenceId, int frame, int totalFrames, uint64_t frameBytes)
+{
+	ofScopedLock lock(mutex);
+	if(!file.is_open()){
+		return;
+	}
+
+	map<int, Sequence>::iterator sequence = sequences.find(sequenceId);
+	if(sequence == sequences.end() || sequence->second.totalFrames != totalFrames || sequence->second.frameBytes != frameBytes){
+		Sequence& info = sequences[sequenceId];
+		info.totalFrames = totalFrames;
+		info.frameBytes = frameBytes;
+		writeHeader(RECORD_SEQUENCE);
+		writeVarint(sequenceId);
+		writeVarint(totalFrames);
+		writeVarint(frameBytes);
+	}
+
+	writeHeader(RECORD_REQUEST);
+	writeVarint(sequenceId);
+	writeVarint(zigzag((int64_t)frame - lastFrames[sequenceId]));
+	lastFrames[sequenceId] = frame;
+
+	if(buffer.size() >= FLUSH_BYTES){
+		flush();
+	}
+}
+
+void ofxImageSequenceTrace::recordDecode(int sequenceId, uint64_t micros)
+{
+	ofScopedLock lock(mutex);
+	if(!file.is_open()){
+		return;
+	}
+	writeHeader(RECORD_DECODE);
+	writeVarint(sequenceId);
+	writeVarint(micros);
+}
+
+bool ofxImageSequenceTrace::load(string path)
+{
+	ofBuffer data = ofBufferFromFile(path, true);
+	const unsigned char* in = (const unsigned char*)data.getData();
+	const unsigned char* end = in + data.size();
+	if(data.size() < sizeof(TRACE_MAGIC) || memcmp(in, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0){
+		ofLogError("ofxImageSequenceTrace::load") << path << " is not a frame request trace";
+		return false;
+	}
+	in += sizeof(TRACE_MAGIC);
+
+	ofScopedLock lock(mutex);
+	requests.clear();
+	sequences.clear();
+
+	bool truncated = false;
+	std::function<uint64_t()> readVarint = [&](){
+		uint64_t value = 0;
+		for(int shift = 0; shift < 64; shift += 7){
+			if(in >= end){
+				truncated = true;
+				return value;
+			}
+			unsigned char byte = *in++;
+			value |= (uint64_t)(byte & 0x7f) << shift;
+			if((byte & 0x80) == 0){
+				break;
+			}
+		}
+		return value;
+	};
+
+	uint64_t micros = 0;
+	map<int, int> frames;
+	while(in < end){
+		uint64_t header = readVarint();
+		int type = header & 3;
+		int sequenceId = (int)readVarint();
+		uint64_t value = readVarint();
+		uint64_t frameBytes = type == RECORD_SEQUENCE ? readVarint() : 0;
+		if(truncated || type > RECORD_DECODE){
+			truncated = true;
+			break;
+		}
+
+		micros += header >> 2;
+		if(type == RECORD_REQUEST){
+			Request request;
+			request.micros = micros;
+			request.sequenceId = sequenceId;
+			request.frame = frames[sequenceId] += (int)unzigzag(value);
+			requests.push_back(request);
+		}
+		else if(type == RECORD_SEQUENCE){
+			sequences[sequenceId].totalFrames = (int)value;
+			sequences[sequenceId].frameBytes = frameBytes;
+		}
+		else{
+			sequences[sequenceId].decodeMicros += value;
+			sequences[sequenceId].decodes++;
+		}
+	}
+	if(truncated){
+		ofLogWarning("ofxImageSequenceTrace::load") << path << " is truncated or damaged, loaded the first " << requests.size() << " requests";
+	}
+	return true;
+}
+
+const vector<ofxImageSequenceTrace::Request>& ofxImageSequenceTrace::getRequests() const
+{
+	return requests;
+}
+
+const map<int, ofxImageSequenceTrace::Sequence>& ofxImageSequenceTrace::getSequences() const
+{
+	return sequences;
+}
+
+uint64_t ofxImageSequenceTrace::getMeanDecodeMicros(int sequenceId) const
+{
+	map<int, Sequence>::const_iterator sequence = sequences.find(sequenceId);
+	if(sequence == sequences.end() || sequence->second.decodes == 0){
+		return 0;
+	}
+	return sequence->second.decodeMicros / sequence->second.decodes;
+}
@@ -0,0 +1,84 @@
+/**
+ *  ofxImageSequenceTrace.h
+ *
+ *  Part of ofxImageSequence, see ofxImageSequence.h for license terms.
+ *
+ * ----------------------
+ *
+ *  ofxImageSequenceTrace records the frame requests of a show into a compact binary file, so cache
+ *  budgets and policies can be evaluated offline against what really played (see example-simulator).
+ *
+ *  Every setFrame on a traced sequence records a request: time since recording started, the id given
+ *  to the sequence and the frame. The frame count and decoded frame size of each sequence are recorded
+ *  when they change, and so is the time of every decode setFrame had to wait for, which gives replays
+ *  the real cost of a miss. Records are varint encoded as deltas, so sequential playback costs about
+ *  three bytes per request.
+ *
+ *	trace.startRecording("show.trace");
+ *	intro.setTrace(&trace, 0);
+ *	loop.setTrace(&trace, 1);
+ *	...
+ *	trace.stopRecording();
+ *
+ *	ofxImageSequenceTrace trace;
+ *	trace.load("show.trace");
+ *	for(int i = 0; i < trace.getRequests().size(); i++){ ... }
+ */
+
+#pragma once
+
+#include "ofMain.h"
+
+class ofxImageSequenceTrace {
+  public:
+
+	struct Request {
+		uint64_t micros;	//since recording started
+		int sequenceId;
+		int frame;
+	};
+
+	struct Sequence {
+		int totalFrames;
+		uint64_t frameBytes;	//decoded size of a full resolution frame
+		uint64_t decodeMicros;	//total time of the decodes recorded
+		int decodes;
+	};
+
+	ofxImageSequenceTrace();
+	~ofxImageSequenceTrace();
+
+	bool startRecording(string path);
+	void stopRecording();	//flushes and closes the file
+	bool isRecording();
+
+	//called by traced sequences, safe from any thread
+	void recordRequest(int sequenceId, int frame, int totalFrames, uint64_t frameBytes);
+	void recordDecode(int sequenceId, uint64_t micros);
+
+	bool load(string path);
+	const vector<Request>& getRequests() const;
+	const map<int, Sequence>& getSequences() const;
+	uint64_t getMeanDecodeMicros(int sequenceId) const;	//0 when no decode of that sequence was recorded
+
+  protected:
+	enum RecordType {
+		RECORD_REQUEST = 0,
+		RECORD_SEQUENCE,
+		RECORD_DECODE
+	};
+
+	void writeHeader(RecordType type);
+	void writeVarint(uint64_t value);
+	void flush();
+
+	ofMutex mutex;
+	ofstream file;
+	vector<unsigned char> buffer;
+	uint64_t startMicros;
+	uint64_t lastMicros;
+	map<int, int> lastFrames;
+
+	vector<Request> requests;
+	map<int, Sequence> sequences;
+};